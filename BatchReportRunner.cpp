@@ -0,0 +1,265 @@
+#include "BatchReportRunner.h"
+#include "HistoryReportPipeline.h"
+#include "MultiReportGenerator.h"
+#include "reportdatamodel.h"
+#include <QCommandLineParser>
+#include <QCommandLineOption>
+#include <QFileInfo>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QDebug>
+#include <cstring>
+
+bool BatchReportRunner::isBatchInvocation(int argc, char* argv[])
+{
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--batch") == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static QDateTime parseDateTimeArgument(const QString& text)
+{
+    QDateTime time = QDateTime::fromString(text, "yyyy-MM-dd HH:mm:ss");
+    if (!time.isValid()) time = QDateTime::fromString(text, "yyyy-MM-dd HH:mm");
+    if (!time.isValid()) time = QDateTime(QDate::fromString(text, "yyyy-MM-dd"), QTime(0, 0, 0));
+    return time;
+}
+
+bool BatchReportRunner::parseArguments(const QStringList& arguments, BatchReportOptions& options, QString& error)
+{
+    QCommandLineParser parser;
+    parser.setApplicationDescription("SCADA报表控件 - 批量生成历史报表");
+    parser.addHelpOption();
+
+    QCommandLineOption batchOption("batch", "无界面批处理模式");
+    QCommandLineOption configOption(QStringList() << "c" << "config", "#REPO_ 报表配置文件（可重复指定多个）", "file");
+    QCommandLineOption configDirOption("config-dir", "目录下全部 #REPO_*.xlsx 配置", "dir");
+    QCommandLineOption typeOption(QStringList() << "t" << "type", "报表类型：daily/weekly/monthly/custom（默认 daily）", "type", "daily");
+    QCommandLineOption startOption(QStringList() << "s" << "start", "起始时间 yyyy-MM-dd[ HH:mm[:ss]]（默认上一个完整周期）", "time");
+    QCommandLineOption endOption(QStringList() << "e" << "end", "终止时间（仅 custom）", "time");
+    QCommandLineOption intervalOption(QStringList() << "i" << "interval", "采样间隔秒数（默认随报表类型）", "seconds");
+    QCommandLineOption outputOption(QStringList() << "o" << "output", "输出文件或目录", "path");
+
+    parser.addOption(batchOption);
+    parser.addOption(configOption);
+    parser.addOption(configDirOption);
+    parser.addOption(typeOption);
+    parser.addOption(startOption);
+    parser.addOption(endOption);
+    parser.addOption(intervalOption);
+    parser.addOption(outputOption);
+
+    parser.process(arguments);
+
+    options.configFiles = parser.values(configOption);
+    if (parser.isSet(configDirOption)) {
+        QDir dir(parser.value(configDirOption));
+        const QStringList names = dir.entryList(QStringList() << "#REPO_*.xlsx", QDir::Files, QDir::Name);
+        for (const QString& name : names) {
+            options.configFiles.append(dir.absoluteFilePath(name));
+        }
+    }
+    options.configFile = options.configFiles.value(0);
+    options.outputPath = parser.value(outputOption);
+    if (options.configFile.isEmpty() || options.outputPath.isEmpty()) {
+        error = "必须指定 --config（或 --config-dir）和 --output";
+        return false;
+    }
+
+    if (!TimeSettingsDialog::parseReportType(parser.value(typeOption), options.type)) {
+        error = QString("未知的报表类型：%1").arg(parser.value(typeOption));
+        return false;
+    }
+
+    if (parser.isSet(startOption)) {
+        options.startTime = parseDateTimeArgument(parser.value(startOption));
+        if (!options.startTime.isValid()) {
+            error = QString("起始时间格式错误：%1").arg(parser.value(startOption));
+            return false;
+        }
+    }
+    if (parser.isSet(endOption)) {
+        options.endTime = parseDateTimeArgument(parser.value(endOption));
+        if (!options.endTime.isValid()) {
+            error = QString("终止时间格式错误：%1").arg(parser.value(endOption));
+            return false;
+        }
+    }
+    if (parser.isSet(intervalOption)) {
+        bool ok = false;
+        options.intervalSeconds = parser.value(intervalOption).toInt(&ok);
+        if (!ok || options.intervalSeconds <= 0) {
+            error = QString("采样间隔无效：%1").arg(parser.value(intervalOption));
+            return false;
+        }
+    }
+    return true;
+}
+
+TimeRangeConfig BatchReportRunner::resolveTimeRange(const BatchReportOptions& options, QString& error)
+{
+    TimeRangeConfig range;
+    range.intervalSeconds = options.intervalSeconds > 0
+        ? options.intervalSeconds
+        : TimeSettingsDialog::defaultIntervalSeconds(options.type);
+
+    const QDate today = QDate::currentDate();
+
+    if (options.type == TimeSettingsDialog::Custom) {
+        if (!options.startTime.isValid() || !options.endTime.isValid()) {
+            error = "custom 类型必须同时指定 --start 和 --end";
+            return TimeRangeConfig(QDateTime(), QDateTime(), 0);
+        }
+        range.startTime = options.startTime;
+        range.endTime = options.endTime;
+    }
+    else {
+        // 未指定起始时间时取上一个完整周期（夜间批处理生成昨日/上周/上月报表）
+        QDateTime start = options.startTime;
+        if (!start.isValid()) {
+            int days = options.type == TimeSettingsDialog::Daily ? 1
+                : options.type == TimeSettingsDialog::Weekly ? 7 : 30;
+            start = QDateTime(today.addDays(-days), QTime(0, 0, 0));
+        }
+        range.startTime = start;
+        range.endTime = TimeSettingsDialog::endTimeFor(options.type, start);
+    }
+
+    if (!range.isValid()) {
+        error = QString("时间范围无效：%1 ~ %2")
+            .arg(range.startTime.toString("yyyy-MM-dd HH:mm:ss"))
+            .arg(range.endTime.toString("yyyy-MM-dd HH:mm:ss"));
+    }
+    return range;
+}
+
+QString BatchReportRunner::resolveOutputFile(const QString& outputPath, const QString& reportName, const QDateTime& startTime)
+{
+    QFileInfo info(outputPath);
+    if (info.isDir() || outputPath.endsWith('/') || outputPath.endsWith('\\')) {
+        QDir dir(outputPath);
+        return dir.filePath(QString("%1_%2.xlsx").arg(reportName).arg(startTime.toString("yyyyMMdd_HHmm")));
+    }
+    return outputPath;
+}
+
+int BatchReportRunner::run(const QStringList& arguments)
+{
+    BatchReportOptions options;
+    QString error;
+    if (!parseArguments(arguments, options, error)) {
+        qWarning().noquote() << "参数错误：" << error;
+        qWarning().noquote() << "用法：ScadaReportControl --batch --config <#REPO_文件> --type <daily|weekly|monthly|custom> --output <路径>";
+        return UsageError;
+    }
+    return options.configFiles.size() > 1 ? runMultiple(options) : run(options);
+}
+
+int BatchReportRunner::runMultiple(const BatchReportOptions& options, HistoryFetchCache* cache)
+{
+    QString error;
+    TimeRangeConfig timeRange = resolveTimeRange(options, error);
+    if (!timeRange.isValid()) {
+        qWarning().noquote() << error;
+        return UsageError;
+    }
+
+    MultiReportGenerator generator(timeRange);
+    generator.setFetchCache(cache);
+
+    for (const QString& configFile : options.configFiles) {
+        if (!generator.addConfig(configFile, error)) {
+            // 单个配置有误不影响其他报表
+            qWarning().noquote() << "跳过配置：" << error;
+        }
+    }
+    if (generator.reportCount() == 0) {
+        return ConfigError;
+    }
+
+    // 多报表时输出路径总是目录
+    QString outputDir = options.outputPath;
+    if (!outputDir.endsWith('/') && !outputDir.endsWith('\\')) {
+        outputDir += '/';
+    }
+
+    MultiReportGenerator::Summary summary;
+    bool ok = generator.run(outputDir, &summary);
+    for (const QString& failed : summary.failedReports) {
+        qWarning().noquote() << "报表失败：" << failed;
+    }
+
+    if (summary.succeeded == 0) {
+        return PipelineError;
+    }
+    return ok && generator.reportCount() == options.configFiles.size() ? Success : PartialFailure;
+}
+
+int BatchReportRunner::run(const BatchReportOptions& options, HistoryFetchCache* cache, BatchReportResult* result)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    QString error;
+    TimeRangeConfig timeRange = resolveTimeRange(options, error);
+    if (!timeRange.isValid()) {
+        qWarning().noquote() << error;
+        return UsageError;
+    }
+
+    QFileInfo configInfo(options.configFile);
+    if (!configInfo.exists()) {
+        qWarning().noquote() << "配置文件不存在：" << options.configFile;
+        return ConfigError;
+    }
+    if (!configInfo.fileName().startsWith("#REPO_")) {
+        qWarning().noquote() << "配置文件名应以 #REPO_ 开头：" << configInfo.fileName();
+    }
+
+    ReportDataModel model;
+    model.setWorkMode(ReportDataModel::HISTORY_MODE);
+    if (!model.loadReportConfig(options.configFile)) {
+        qWarning().noquote() << "配置文件格式错误：" << options.configFile;
+        return ConfigError;
+    }
+
+    HistoryReportPipeline pipeline(&model);
+    pipeline.setFetchCache(cache);
+    if (!pipeline.prepare(timeRange) || !pipeline.execute()) {
+        qWarning().noquote() << "报表生成失败：" << pipeline.errorString();
+        return PipelineError;
+    }
+
+    for (const QString& failed : pipeline.failedColumns()) {
+        qWarning().noquote() << "数据缺失：" << failed;
+    }
+
+    QString outputFile = resolveOutputFile(options.outputPath, model.getReportName(), timeRange.startTime);
+    QDir().mkpath(QFileInfo(outputFile).absolutePath());
+    if (!model.exportHistoryReportToExcel(outputFile)) {
+        qWarning().noquote() << "导出失败：" << outputFile;
+        return ExportError;
+    }
+
+    if (result) {
+        result->outputFile = outputFile;
+        result->points = pipeline.pointCount();
+        result->columns = pipeline.columnCount();
+        result->failedColumns = pipeline.failedColumns();
+        result->fetchMs = pipeline.fetchMs();
+        result->alignMs = pipeline.alignMs();
+        result->totalMs = timer.elapsed();
+    }
+
+    qDebug().noquote() << QString("已生成 %1：%2 行 × %3 列，%4 ~ %5，总耗时 %6 ms")
+        .arg(outputFile)
+        .arg(pipeline.pointCount())
+        .arg(pipeline.columnCount())
+        .arg(timeRange.startTime.toString("yyyy-MM-dd HH:mm:ss"))
+        .arg(timeRange.endTime.toString("yyyy-MM-dd HH:mm:ss"))
+        .arg(timer.elapsed());
+    return Success;
+}
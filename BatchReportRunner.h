@@ -0,0 +1,77 @@
+#pragma once
+#ifndef BATCHREPORTRUNNER_H
+#define BATCHREPORTRUNNER_H
+
+#include <QString>
+#include <QStringList>
+#include <QDateTime>
+
+#include "DataBindingConfig.h"
+#include "TimeSettingsDialog.h"
+
+// 批处理报表参数（命令行 --batch）
+struct BatchReportOptions {
+    QString configFile;                     // #REPO_ 配置文件
+    QStringList configFiles;                // 多个配置时的全部文件（多报表模式）
+    TimeSettingsDialog::ReportType type;
+    QDateTime startTime;                    // 为空时取上一个完整周期
+    QDateTime endTime;                      // 仅自定义类型使用
+    int intervalSeconds;                    // <=0 时取报表类型默认值
+    QString outputPath;                     // 文件或目录
+
+    BatchReportOptions()
+        : type(TimeSettingsDialog::Daily)
+        , intervalSeconds(0)
+    {
+    }
+};
+
+class HistoryFetchCache;
+
+// 单个批处理报表的执行结果
+struct BatchReportResult {
+    QString outputFile;
+    int points = 0;
+    int columns = 0;
+    QStringList failedColumns;
+    qint64 fetchMs = 0;
+    qint64 alignMs = 0;
+    qint64 totalMs = 0;
+};
+
+// 无界面历史报表生成：加载配置 → 查询 → 对齐 → 导出
+class BatchReportRunner
+{
+public:
+    enum ExitCode {
+        Success = 0,
+        UsageError = 1,
+        ConfigError = 2,
+        PipelineError = 3,
+        ExportError = 4,
+        PartialFailure = 5      // 多报表模式下部分报表失败
+    };
+
+    // 命令行是否请求批处理（需在创建 QApplication 之前判断以选择 offscreen 平台）
+    static bool isBatchInvocation(int argc, char* argv[]);
+
+    // 解析命令行并执行，返回进程退出码
+    static int run(const QStringList& arguments);
+
+    // 多报表模式：同一时间范围下的全部配置一起生成，相同 RTU 只查询一次
+    static int runMultiple(const BatchReportOptions& options, HistoryFetchCache* cache = nullptr);
+
+    // 执行单个报表；cache 非空时与其他报表共用查询结果
+    static int run(const BatchReportOptions& options, HistoryFetchCache* cache = nullptr,
+        BatchReportResult* result = nullptr);
+
+    static bool parseArguments(const QStringList& arguments, BatchReportOptions& options, QString& error);
+
+    // 由报表类型、起始时间和间隔得到时间范围；参数不完整时返回无效配置
+    static TimeRangeConfig resolveTimeRange(const BatchReportOptions& options, QString& error);
+
+    // 输出路径为目录时生成 "报表名_起始时间.xlsx"
+    static QString resolveOutputFile(const QString& outputPath, const QString& reportName, const QDateTime& startTime);
+};
+
+#endif // BATCHREPORTRUNNER_H
@@ -0,0 +1,257 @@
+#include "CellTextIndex.h"
+#include "reportdatamodel.h"
+#include <QRegularExpression>
+#include <QElapsedTimer>
+#include <QDebug>
+#include <algorithm>
+
+// dataChanged 区域超过该单元格数时改为整体重建
+static const int kIncrementalLimit = 4096;
+
+CellTextIndex::CellTextIndex(ReportDataModel* model, QObject* parent)
+    : QObject(parent)
+    , m_model(model)
+    , m_dirty(true)
+    , m_postingCount(0)
+    , m_staleCount(0)
+    , m_version(0)
+    , m_cachedVersion(~0ULL)
+    , m_cachedWildcard(false)
+{
+    connect(m_model, &QAbstractItemModel::dataChanged, this, &CellTextIndex::onDataChanged);
+    connect(m_model, &QAbstractItemModel::modelReset, this, &CellTextIndex::invalidate);
+    connect(m_model, &QAbstractItemModel::layoutChanged, this, &CellTextIndex::invalidate);
+    connect(m_model, &QAbstractItemModel::rowsInserted, this, &CellTextIndex::invalidate);
+    connect(m_model, &QAbstractItemModel::rowsRemoved, this, &CellTextIndex::invalidate);
+    connect(m_model, &QAbstractItemModel::columnsInserted, this, &CellTextIndex::invalidate);
+    connect(m_model, &QAbstractItemModel::columnsRemoved, this, &CellTextIndex::invalidate);
+}
+
+quint64 CellTextIndex::trigramKey(const QChar* p)
+{
+    return (static_cast<quint64>(p[0].unicode()) << 32) |
+        (static_cast<quint64>(p[1].unicode()) << 16) |
+        static_cast<quint64>(p[2].unicode());
+}
+
+void CellTextIndex::invalidate()
+{
+    m_dirty = true;
+    ++m_version;
+}
+
+void CellTextIndex::onDataChanged(const QModelIndex& topLeft, const QModelIndex& bottomRight, const QVector<int>& roles)
+{
+    // 只有文本可能变化时才需要更新索引（用户编辑只带 EditRole；迷你趋势等其他角色的通知直接忽略）
+    if (m_dirty) return;
+    if (!roles.isEmpty() && !roles.contains(Qt::DisplayRole) && !roles.contains(Qt::EditRole)) return;
+
+    const int rows = bottomRight.row() - topLeft.row() + 1;
+    const int cols = bottomRight.column() - topLeft.column() + 1;
+    if (static_cast<qint64>(rows) * cols > kIncrementalLimit) {
+        invalidate();
+        return;
+    }
+
+    for (int row = topLeft.row(); row <= bottomRight.row(); ++row) {
+        for (int col = topLeft.column(); col <= bottomRight.column(); ++col) {
+            updateCell(row, col);
+        }
+    }
+
+    // 过期倒排项过多时整体重建
+    if (m_staleCount > m_postingCount / 2 + 1024) {
+        invalidate();
+    }
+}
+
+void CellTextIndex::ensureBuilt()
+{
+    if (m_dirty) {
+        rebuild();
+    }
+}
+
+void CellTextIndex::rebuild()
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    m_slots.clear();
+    m_slotOf.clear();
+    m_postings.clear();
+    m_postingCount = 0;
+    m_staleCount = 0;
+    m_dirty = false;
+    ++m_version;
+
+    // 历史报表：时间列 + 数据列为整列数据；其余（公式列、实时单元格）只索引存在的单元格
+    if (m_model->isHistoryMode()) {
+        const int rows = m_model->rowCount();
+        const int cols = m_model->getHistoryConfig().columns.size() + 1;
+        m_slots.reserve(rows * cols);
+        for (int row = 0; row < rows; ++row) {
+            for (int col = 0; col < cols; ++col) {
+                updateCell(row, col);
+            }
+        }
+    }
+
+    const auto& cells = m_model->getAllCells();
+    for (auto it = cells.constBegin(); it != cells.constEnd(); ++it) {
+        updateCell(it.key().x(), it.key().y());
+    }
+
+    qDebug() << "文本索引已重建：" << m_slots.size() << "个单元格，" << m_postings.size()
+        << "个三元组，耗时" << timer.elapsed() << "ms";
+}
+
+void CellTextIndex::updateCell(int row, int col)
+{
+    const QPoint pos(row, col);
+    QString text = m_model->data(m_model->index(row, col), Qt::DisplayRole).toString().toCaseFolded();
+
+    int slot = m_slotOf.value(pos, -1);
+    if (slot < 0) {
+        if (text.isEmpty()) return;
+
+        slot = m_slots.size();
+        m_slots.append({ row, col, text });
+        m_slotOf.insert(pos, slot);
+        addPostings(slot);
+        ++m_version;
+        return;
+    }
+
+    Slot& entry = m_slots[slot];
+    if (entry.text == text) return;
+
+    // 旧倒排项不删除，查询时按实际文本校验；只记账以便触发重建
+    m_staleCount += qMax(0, entry.text.length() - 2);
+    entry.text = text;
+    addPostings(slot);
+    ++m_version;
+}
+
+void CellTextIndex::addPostings(int slot)
+{
+    const QString& text = m_slots[slot].text;
+    if (text.length() < 3) return;
+
+    const QChar* data = text.constData();
+    quint64 previous = ~0ULL;
+    for (int i = 0; i + 3 <= text.length(); ++i) {
+        quint64 key = trigramKey(data + i);
+        if (key == previous) continue;   // 连续重复（如 "000"）只记一次
+        previous = key;
+
+        QVector<int>& postings = m_postings[key];
+        if (postings.isEmpty() || postings.last() != slot) {
+            postings.append(slot);
+            ++m_postingCount;
+        }
+    }
+}
+
+// 候选槽位：取字面串中倒排表最短的三元组；字面串不足3个字符时返回全部槽位
+QVector<int> CellTextIndex::candidateSlots(const QString& literal)
+{
+    QVector<int> result;
+
+    if (literal.length() < 3) {
+        result.reserve(m_slots.size());
+        for (int i = 0; i < m_slots.size(); ++i) result.append(i);
+        return result;
+    }
+
+    const QVector<int>* best = nullptr;
+    for (int i = 0; i + 3 <= literal.length(); ++i) {
+        auto it = m_postings.constFind(trigramKey(literal.constData() + i));
+        if (it == m_postings.constEnd()) {
+            return result;     // 某个三元组不存在，必然无匹配
+        }
+        if (!best || it.value().size() < best->size()) {
+            best = &it.value();
+        }
+    }
+
+    result = *best;
+    std::sort(result.begin(), result.end());
+    result.erase(std::unique(result.begin(), result.end()), result.end());
+    return result;
+}
+
+const QVector<QPoint>& CellTextIndex::findCells(const QString& pattern, bool wildcard)
+{
+    ensureBuilt();
+
+    const QString folded = pattern.toCaseFolded();
+    if (m_cachedVersion == m_version && m_cachedWildcard == wildcard && m_cachedPattern == folded) {
+        return m_cachedMatches;
+    }
+
+    m_cachedMatches.clear();
+    m_cachedPattern = folded;
+    m_cachedWildcard = wildcard;
+    m_cachedVersion = m_version;
+
+    if (folded.isEmpty()) {
+        return m_cachedMatches;
+    }
+
+    QRegularExpression regex;
+    QString literal = folded;
+    if (wildcard) {
+        // 转换通配符为正则表达式
+        QString regexPattern = QRegularExpression::escape(folded);
+        regexPattern.replace("\\*", ".*");
+        regexPattern.replace("\\?", ".");
+        regex.setPattern(regexPattern);
+
+        // 用最长的字面片段筛选候选
+        literal.clear();
+        const QStringList fragments = folded.split(QRegularExpression("[*?]"), Qt::SkipEmptyParts);
+        for (const QString& fragment : fragments) {
+            if (fragment.length() > literal.length()) literal = fragment;
+        }
+    }
+
+    const QVector<int> candidates = candidateSlots(literal);
+    for (int slot : candidates) {
+        const Slot& entry = m_slots[slot];
+        bool match = wildcard ? regex.match(entry.text).hasMatch() : entry.text.contains(folded);
+        if (match) {
+            m_cachedMatches.append(QPoint(entry.row, entry.col));
+        }
+    }
+
+    std::sort(m_cachedMatches.begin(), m_cachedMatches.end(), [](const QPoint& a, const QPoint& b) {
+        return a.x() != b.x() ? a.x() < b.x() : a.y() < b.y();
+    });
+    return m_cachedMatches;
+}
+
+QPoint CellTextIndex::findNext(const QString& pattern, int row, int col)
+{
+    const QVector<QPoint>& matches = findCells(pattern);
+    if (matches.isEmpty()) return QPoint(-1, -1);
+
+    // 二分查找 (row, col) 之后的第一个匹配
+    auto it = std::upper_bound(matches.begin(), matches.end(), QPoint(row, col), [](const QPoint& a, const QPoint& b) {
+        return a.x() != b.x() ? a.x() < b.x() : a.y() < b.y();
+    });
+    return it != matches.end() ? *it : matches.first();
+}
+
+QVector<int> CellTextIndex::matchingRows(const QString& pattern, bool wildcard)
+{
+    const QVector<QPoint>& matches = findCells(pattern, wildcard);
+
+    QVector<int> rows;
+    for (const QPoint& pos : matches) {
+        if (rows.isEmpty() || rows.last() != pos.x()) {
+            rows.append(pos.x());
+        }
+    }
+    return rows;
+}
@@ -0,0 +1,73 @@
+#pragma once
+#ifndef CELLTEXTINDEX_H
+#define CELLTEXTINDEX_H
+
+#include <QObject>
+#include <QHash>
+#include <QVector>
+#include <QPoint>
+#include <QString>
+
+class ReportDataModel;
+class QModelIndex;
+
+// 单元格文本倒排索引（三字符 n-gram → 单元格槽位）
+// - 建立一次，之后跟随模型的 dataChanged 增量更新，结构变化时延迟重建
+// - 查找/筛选只查倒排表并校验候选，不再遍历并格式化整张表
+// - 大小写不敏感；筛选支持通配符 * 和 ?
+class CellTextIndex : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit CellTextIndex(ReportDataModel* model, QObject* parent = nullptr);
+
+    // 所有匹配单元格，按行优先排序（QPoint 的 x 为行、y 为列）
+    const QVector<QPoint>& findCells(const QString& pattern, bool wildcard = false);
+
+    // 从 (row, col) 之后开始查找下一个匹配，到末尾后回到开头；未找到返回 (-1, -1)
+    QPoint findNext(const QString& pattern, int row, int col);
+
+    // 包含匹配单元格的行（升序，去重）
+    QVector<int> matchingRows(const QString& pattern, bool wildcard = false);
+
+    int indexedCellCount() const { return m_slots.size(); }
+
+private slots:
+    void onDataChanged(const QModelIndex& topLeft, const QModelIndex& bottomRight, const QVector<int>& roles);
+    void invalidate();
+
+private:
+    struct Slot {
+        int row;
+        int col;
+        QString text;      // 已做大小写折叠
+    };
+
+    void ensureBuilt();
+    void rebuild();
+    void updateCell(int row, int col);
+    void addPostings(int slot);
+    QVector<int> candidateSlots(const QString& literal);
+
+    static quint64 trigramKey(const QChar* p);
+
+private:
+    ReportDataModel* m_model;
+    bool m_dirty;
+
+    QVector<Slot> m_slots;
+    QHash<QPoint, int> m_slotOf;
+    QHash<quint64, QVector<int>> m_postings;
+    int m_postingCount;
+    int m_staleCount;          // 单元格文本更新后残留的过期倒排项
+
+    // 最近一次查询结果缓存（索引变化后失效）
+    quint64 m_version;
+    quint64 m_cachedVersion;
+    QString m_cachedPattern;
+    bool m_cachedWildcard;
+    QVector<QPoint> m_cachedMatches;
+};
+
+#endif // CELLTEXTINDEX_H
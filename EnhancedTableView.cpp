@@ -1,19 +1,71 @@
 #include "EnhancedTableView.h"
 #include "reportdatamodel.h"
 #include "DataBindingConfig.h"
+#include "PipelineTrace.h"
 #include <QPaintEvent>
 #include <QPainter>
 #include <QHeaderView>
 #include <QAbstractProxyModel>
 #include <QPen>
 
+// ߿򻺴ֿС  У
+static const int kBorderRowBand = 32;
+static const int kBorderColBand = 16;
+
 EnhancedTableView::EnhancedTableView(QWidget* parent)
     : QTableView(parent)
+    , m_borderSpanRows(0)
+    , m_borderSpanCols(0)
+    , m_borderCacheDirty(true)
+{
+    // ип仯߿λʧЧ
+    connect(horizontalHeader(), &QHeaderView::sectionResized, this, &EnhancedTableView::invalidateBorderCache);
+    connect(verticalHeader(), &QHeaderView::sectionResized, this, &EnhancedTableView::invalidateBorderCache);
+    connect(horizontalHeader(), &QHeaderView::sectionCountChanged, this, &EnhancedTableView::invalidateBorderCache);
+    connect(verticalHeader(), &QHeaderView::sectionCountChanged, this, &EnhancedTableView::invalidateBorderCache);
+}
+
+void EnhancedTableView::setModel(QAbstractItemModel* newModel)
+{
+    // ͬһģʱ QAbstractItemView::setModel ֱӷأȶϿ
+    if (newModel == model()) {
+        return;
+    }
+
+    // ֻϿ߿򻺴ӣͼģ͵ QTableView::setModel 
+    if (QAbstractItemModel* oldModel = model()) {
+        disconnect(oldModel, &QAbstractItemModel::modelReset, this, &EnhancedTableView::invalidateBorderCache);
+        disconnect(oldModel, &QAbstractItemModel::layoutChanged, this, &EnhancedTableView::invalidateBorderCache);
+        disconnect(oldModel, &QAbstractItemModel::rowsInserted, this, &EnhancedTableView::invalidateBorderCache);
+        disconnect(oldModel, &QAbstractItemModel::rowsRemoved, this, &EnhancedTableView::invalidateBorderCache);
+        disconnect(oldModel, &QAbstractItemModel::columnsInserted, this, &EnhancedTableView::invalidateBorderCache);
+        disconnect(oldModel, &QAbstractItemModel::columnsRemoved, this, &EnhancedTableView::invalidateBorderCache);
+    }
+
+    QTableView::setModel(newModel);
+
+    if (newModel) {
+        // ֵˢ£dataChangedӰ߿ֻнṹ仯ؽ
+        connect(newModel, &QAbstractItemModel::modelReset, this, &EnhancedTableView::invalidateBorderCache);
+        connect(newModel, &QAbstractItemModel::layoutChanged, this, &EnhancedTableView::invalidateBorderCache);
+        connect(newModel, &QAbstractItemModel::rowsInserted, this, &EnhancedTableView::invalidateBorderCache);
+        connect(newModel, &QAbstractItemModel::rowsRemoved, this, &EnhancedTableView::invalidateBorderCache);
+        connect(newModel, &QAbstractItemModel::columnsInserted, this, &EnhancedTableView::invalidateBorderCache);
+        connect(newModel, &QAbstractItemModel::columnsRemoved, this, &EnhancedTableView::invalidateBorderCache);
+    }
+    invalidateBorderCache();
+}
+
+void EnhancedTableView::invalidateBorderCache()
 {
+    m_borderCacheDirty = true;
+    m_borderTiles.clear();
+    viewport()->update();
 }
 
 void EnhancedTableView::paintEvent(QPaintEvent* event)
 {
+    TRACE_SCOPE("ui.paint");
     // ȵûĻ
     QTableView::paintEvent(event);
 
@@ -27,7 +79,10 @@ void EnhancedTableView::drawBorders(QPainter* painter)
     ReportDataModel* reportModel = getReportModel();
     if (!reportModel) return;
 
-    painter->save();
+    if (m_borderCacheDirty) {
+        rebuildBorderCache();
+    }
+    if (m_borderTiles.isEmpty()) return;
 
     // ȡɼ
     QRect viewportRect = viewport()->rect();
@@ -37,72 +92,29 @@ void EnhancedTableView::drawBorders(QPainter* painter)
     int lastCol = columnAt(viewportRect.right());
 
     if (firstRow < 0) firstRow = 0;
-    if (lastRow < 0) lastRow = reportModel->rowCount() - 1;
+    if (lastRow < 0) lastRow = model()->rowCount() - 1;
     if (firstCol < 0) firstCol = 0;
-    if (lastCol < 0) lastCol = reportModel->columnCount() - 1;
-
-    // ÿԪı߿
-    for (int row = firstRow; row <= lastRow; ++row) {
-        for (int col = firstCol; col <= lastCol; ++col) {
-            const CellData* cell = reportModel->getCell(row, col);
-            if (!cell) continue;
-
-            QModelIndex index = reportModel->index(row, col);
-            QRect cellRect = visualRect(index);
-
-            // ϲԪ
-            QSize spanSize = reportModel->span(index);
-            if (spanSize.width() > 1 || spanSize.height() > 1) {
-                // ϲԪ
-                for (int r = 1; r < spanSize.height(); ++r) {
-                    QModelIndex spanIndex = reportModel->index(row + r, col);
-                    cellRect = cellRect.united(visualRect(spanIndex));
-                }
-                for (int c = 1; c < spanSize.width(); ++c) {
-                    QModelIndex spanIndex = reportModel->index(row, col + c);
-                    cellRect = cellRect.united(visualRect(spanIndex));
-                }
-                for (int r = 1; r < spanSize.height(); ++r) {
-                    for (int c = 1; c < spanSize.width(); ++c) {
-                        QModelIndex spanIndex = reportModel->index(row + r, col + c);
-                        cellRect = cellRect.united(visualRect(spanIndex));
-                    }
-                }
-            }
+    if (lastCol < 0) lastCol = model()->columnCount() - 1;
 
-            // Ʊ߿
-            const RTCellBorder& border = cell->style.border;
+    painter->save();
 
-            // ߿
-            if (border.left != RTBorderStyle::None) {
-                QPen pen(border.leftColor);
-                pen.setWidth(static_cast<int>(border.left));
-                painter->setPen(pen);
-                painter->drawLine(cellRect.topLeft(), cellRect.bottomLeft());
-            }
+    // ߶꣬ƽƺֱӻ
+    painter->translate(-horizontalOffset(), -verticalOffset());
 
-            // ұ߿
-            if (border.right != RTBorderStyle::None) {
-                QPen pen(border.rightColor);
-                pen.setWidth(static_cast<int>(border.right));
-                painter->setPen(pen);
-                painter->drawLine(cellRect.topRight(), cellRect.bottomRight());
-            }
+    // /ϲȻؿԪӿĺϲԪٶһ/УڵԪĴֱ߿
+    int firstRowBand = qMax(0, firstRow - m_borderSpanRows - 1) / kBorderRowBand;
+    int lastRowBand = lastRow / kBorderRowBand;
+    int firstColBand = qMax(0, firstCol - m_borderSpanCols - 1) / kBorderColBand;
+    int lastColBand = lastCol / kBorderColBand;
 
-            // ϱ߿
-            if (border.top != RTBorderStyle::None) {
-                QPen pen(border.topColor);
-                pen.setWidth(static_cast<int>(border.top));
-                painter->setPen(pen);
-                painter->drawLine(cellRect.topLeft(), cellRect.topRight());
-            }
+    for (int rowBand = firstRowBand; rowBand <= lastRowBand; ++rowBand) {
+        for (int colBand = firstColBand; colBand <= lastColBand; ++colBand) {
+            auto tile = m_borderTiles.constFind(tileKey(rowBand, colBand));
+            if (tile == m_borderTiles.constEnd()) continue;
 
-            // ±߿
-            if (border.bottom != RTBorderStyle::None) {
-                QPen pen(border.bottomColor);
-                pen.setWidth(static_cast<int>(border.bottom));
-                painter->setPen(pen);
-                painter->drawLine(cellRect.bottomLeft(), cellRect.bottomRight());
+            for (const PenGroup& group : tile.value()) {
+                painter->setPen(group.pen);
+                painter->drawLines(group.lines);
             }
         }
     }
@@ -110,6 +122,122 @@ void EnhancedTableView::drawBorders(QPainter* painter)
     painter->restore();
 }
 
+void EnhancedTableView::rebuildBorderCache()
+{
+    m_borderTiles.clear();
+    m_borderSpanRows = 0;
+    m_borderSpanCols = 0;
+    m_borderCacheDirty = false;
+
+    ReportDataModel* reportModel = getReportModel();
+    if (!reportModel) return;
+
+    QHeaderView* vHeader = verticalHeader();
+    QHeaderView* hHeader = horizontalHeader();
+
+    // ÿڣʣɫ+ȣ ±
+    QHash<qint64, QHash<quint64, int>> penIndexes;
+    const QVector<QAbstractProxyModel*> proxies = proxyChain();
+
+    const auto& allCells = reportModel->getAllCells();
+    for (auto it = allCells.constBegin(); it != allCells.constEnd(); ++it) {
+        const CellData* cell = it.value();
+        if (!cell) continue;
+
+        const RTCellBorder& border = cell->style.border;
+        if (border.left == RTBorderStyle::None && border.right == RTBorderStyle::None &&
+            border.top == RTBorderStyle::None && border.bottom == RTBorderStyle::None) {
+            continue;
+        }
+
+        // ģ͵ӳ䵽ͼģܾͣɸѡ
+        const QModelIndex reportIndex = reportModel->index(it.key().x(), it.key().y());
+        QModelIndex viewIndex = reportIndex;
+        for (QAbstractProxyModel* proxyModel : proxies) {
+            viewIndex = proxyModel->mapFromSource(viewIndex);
+            if (!viewIndex.isValid()) break;
+        }
+        if (!viewIndex.isValid()) continue;
+
+        int row = viewIndex.row();
+        int col = viewIndex.column();
+        if (vHeader->isSectionHidden(row) || hHeader->isSectionHidden(col)) continue;
+
+        // ϲԪֱλü
+        QSize spanSize = reportModel->span(reportIndex);
+        int lastRow = qMin(row + qMax(1, spanSize.height()) - 1, model()->rowCount() - 1);
+        int lastCol = qMin(col + qMax(1, spanSize.width()) - 1, model()->columnCount() - 1);
+        m_borderSpanRows = qMax(m_borderSpanRows, lastRow - row);
+        m_borderSpanCols = qMax(m_borderSpanCols, lastCol - col);
+
+        int top = vHeader->sectionPosition(row);
+        int bottom = vHeader->sectionPosition(lastRow) + vHeader->sectionSize(lastRow) - 1;
+        int left = hHeader->sectionPosition(col);
+        int right = hHeader->sectionPosition(lastCol) + hHeader->sectionSize(lastCol) - 1;
+        QRect cellRect(QPoint(left, top), QPoint(right, bottom));
+
+        qint64 key = tileKey(row / kBorderRowBand, col / kBorderColBand);
+        BorderTile& tile = m_borderTiles[key];
+        QHash<quint64, int>& penIndex = penIndexes[key];
+
+        // ߿
+        if (border.left != RTBorderStyle::None) {
+            addBorderLine(tile, penIndex, border.leftColor, static_cast<int>(border.left),
+                QLine(cellRect.topLeft(), cellRect.bottomLeft()));
+        }
+
+        // ұ߿
+        if (border.right != RTBorderStyle::None) {
+            addBorderLine(tile, penIndex, border.rightColor, static_cast<int>(border.right),
+                QLine(cellRect.topRight(), cellRect.bottomRight()));
+        }
+
+        // ϱ߿
+        if (border.top != RTBorderStyle::None) {
+            addBorderLine(tile, penIndex, border.topColor, static_cast<int>(border.top),
+                QLine(cellRect.topLeft(), cellRect.topRight()));
+        }
+
+        // ±߿
+        if (border.bottom != RTBorderStyle::None) {
+            addBorderLine(tile, penIndex, border.bottomColor, static_cast<int>(border.bottom),
+                QLine(cellRect.bottomLeft(), cellRect.bottomRight()));
+        }
+    }
+}
+
+void EnhancedTableView::addBorderLine(BorderTile& tile, QHash<quint64, int>& penIndex,
+    const QColor& color, int width, const QLine& line)
+{
+    const quint64 key = (static_cast<quint64>(color.rgba()) << 8) | static_cast<quint8>(width);
+    auto it = penIndex.constFind(key);
+    int group;
+    if (it == penIndex.constEnd()) {
+        PenGroup newGroup;
+        newGroup.pen = QPen(color);
+        newGroup.pen.setWidth(width);
+        group = tile.size();
+        tile.append(newGroup);
+        penIndex.insert(key, group);
+    }
+    else {
+        group = it.value();
+    }
+    tile[group].lines.append(line);
+}
+
+// ͼģ͵ģ֮Ĵ⣩
+QVector<QAbstractProxyModel*> EnhancedTableView::proxyChain() const
+{
+    QVector<QAbstractProxyModel*> proxies;
+    QAbstractItemModel* currentModel = model();
+    while (QAbstractProxyModel* proxyModel = qobject_cast<QAbstractProxyModel*>(currentModel)) {
+        proxies.prepend(proxyModel);
+        currentModel = proxyModel->sourceModel();
+    }
+    return proxies;
+}
+
 void EnhancedTableView::setSpan(int row, int column, int rowSpanCount, int columnSpanCount)
 {
     QTableView::setSpan(row, column, rowSpanCount, columnSpanCount);
@@ -122,6 +250,7 @@ void EnhancedTableView::updateSpans()
 
     // еĺϲԪ
     clearSpans();
+    invalidateBorderCache();
 
     // кϲԪ
     const auto& allCells = reportModel->getAllCells();
@@ -4,8 +4,13 @@
 #include <QTableView>
 #include <QPainter>
 #include <QStyleOption>
+#include <QHash>
+#include <QVector>
+#include <QLine>
+#include <QPen>
 
 class ReportDataModel;
+class QAbstractProxyModel;
 
 class EnhancedTableView : public QTableView
 {
@@ -17,13 +22,36 @@ public:
     // ºϲԪʾ
     void updateSpans();
 
+    void setModel(QAbstractItemModel* model) override;
+
+    // Ԫʽ仯ãģáɾߴ仯ԶʧЧ
+    void invalidateBorderCache();
+
 protected:
     void paintEvent(QPaintEvent* event) override;
 
 private:
+    // ߿򻺴棺Ԫзֿ飬߶ΰʷ飨꣬ʱؽ
+    struct PenGroup {
+        QPen pen;
+        QVector<QLine> lines;
+    };
+    typedef QVector<PenGroup> BorderTile;
+
     void drawBorders(QPainter* painter);
+    void rebuildBorderCache();
+    void addBorderLine(BorderTile& tile, QHash<quint64, int>& penIndex,
+        const QColor& color, int width, const QLine& line);
+    QVector<QAbstractProxyModel*> proxyChain() const;
+    static qint64 tileKey(int rowBand, int colBand) { return (static_cast<qint64>(rowBand) << 32) | static_cast<quint32>(colBand); }
+
     void setSpan(int row, int column, int rowSpanCount, int columnSpanCount);
     ReportDataModel* getReportModel() const;
+
+    QHash<qint64, BorderTile> m_borderTiles;
+    int m_borderSpanRows;     // ߿ĺϲԪ/
+    int m_borderSpanCols;
+    bool m_borderCacheDirty;
 };
 
 #endif // ENHANCEDTABLEVIEW_H
\ No newline at end of file
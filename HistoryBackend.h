@@ -0,0 +1,28 @@
+#pragma once
+#ifndef HISTORYBACKEND_H
+#define HISTORYBACKEND_H
+
+#include <map>
+#include <vector>
+#include <string>
+#include <memory>
+#include <cstdint>
+
+// 历史库读取后端：TaosDataFetcher 解析地址后调用
+// 默认是 TDengine（taosdbapi），开发/压测时可换成进程内模拟
+class HistoryBackend
+{
+public:
+    virtual ~HistoryBackend() {}
+
+    virtual const char* name() const = 0;
+
+    // 与 taosdbapi::read 语义一致：秒级时间戳 → 各 YCNO 的值（顺序同 ycnoList）；失败抛出异常
+    virtual std::map<int64_t, std::vector<float>> read(const std::vector<std::string>& ycnoList,
+        const std::string& startTime, const std::string& endTime, int interval) = 0;
+
+    // 按环境变量 SCADA_HISTORY_BACKEND 创建（mock 为模拟后端，其他为 TDengine）
+    static std::unique_ptr<HistoryBackend> create();
+};
+
+#endif // HISTORYBACKEND_H
@@ -0,0 +1,188 @@
+#include "HistoryFetchCache.h"
+#include "HistoryReportPipeline.h"
+#include "TaosDataFetcher.h"
+#include <QMutexLocker>
+#include <QDebug>
+
+HistoryFetchCache::HistoryFetchCache(qint64 maxPoints)
+    : m_maxPoints(maxPoints)
+    , m_useCounter(0)
+{
+}
+
+QString HistoryFetchCache::seriesKey(const QString& rtuId, int intervalSeconds)
+{
+    return QString("%1#%2").arg(rtuId).arg(intervalSeconds);
+}
+
+HistoryFetchCache::SeriesData HistoryFetchCache::slice(const SeriesData& data, qint64 startSecs, qint64 endSecs)
+{
+    return SeriesData(data.lower_bound(startSecs), data.upper_bound(endSecs));
+}
+
+const HistoryFetchCache::Entry* HistoryFetchCache::findCovering(const QString& key, qint64 startSecs, qint64 endSecs)
+{
+    auto it = m_entries.find(key);
+    if (it == m_entries.end()) return nullptr;
+
+    for (Entry& entry : it.value()) {
+        if (entry.startSecs <= startSecs && entry.endSecs >= endSecs) {
+            entry.lastUsed = ++m_useCounter;
+            return &entry;
+        }
+    }
+    return nullptr;
+}
+
+bool HistoryFetchCache::hasCoveringPending(const QString& key, qint64 startSecs, qint64 endSecs) const
+{
+    for (const Pending& pending : m_pending) {
+        if (pending.key == key && pending.startSecs <= startSecs && pending.endSecs >= endSecs) {
+            return true;
+        }
+    }
+    return false;
+}
+
+HistoryFetchCache::SeriesData HistoryFetchCache::fetch(TaosDataFetcher& fetcher, const QString& rtuId,
+    const TimeRangeConfig& timeRange)
+{
+    const QString key = seriesKey(rtuId, timeRange.intervalSeconds);
+    const qint64 startSecs = timeRange.startTime.toSecsSinceEpoch();
+    const qint64 endSecs = timeRange.endTime.toSecsSinceEpoch();
+
+    std::shared_ptr<const SeriesData> cached;
+    {
+        QMutexLocker locker(&m_mutex);
+        ++m_stats.requests;
+
+        // 同一数据正在被其他报表查询：等它完成
+        bool waited = false;
+        while (hasCoveringPending(key, startSecs, endSecs)) {
+            waited = true;
+            m_pendingDone.wait(&m_mutex);
+        }
+
+        if (const Entry* entry = findCovering(key, startSecs, endSecs)) {
+            ++m_stats.hits;
+            if (waited) ++m_stats.waits;
+            cached = entry->data;
+        }
+        else {
+            ++m_stats.misses;
+            m_pending.append({ key, startSecs, endSecs });
+        }
+    }
+
+    if (cached) {
+        // 截取在锁外进行
+        return slice(*cached, startSecs, endSecs);
+    }
+
+    SeriesData data;
+    try {
+        data = fetcher.fetchDataFromAddress(HistoryReportPipeline::buildAddress(rtuId, timeRange).toStdString());
+    }
+    catch (...) {
+        QMutexLocker locker(&m_mutex);
+        removePendingLocked(key, startSecs, endSecs);
+        m_pendingDone.wakeAll();
+        throw;
+    }
+
+    QMutexLocker locker(&m_mutex);
+    removePendingLocked(key, startSecs, endSecs);
+
+    // 空结果不缓存（可能是连接问题），下次重新查询
+    if (!data.empty()) {
+        Entry entry;
+        entry.startSecs = startSecs;
+        entry.endSecs = endSecs;
+        entry.points = static_cast<qint64>(data.size());
+        entry.data = std::make_shared<const SeriesData>(data);
+        entry.lastUsed = ++m_useCounter;
+        insertLocked(key, entry);
+    }
+    m_pendingDone.wakeAll();
+    return data;
+}
+
+void HistoryFetchCache::removePendingLocked(const QString& key, qint64 startSecs, qint64 endSecs)
+{
+    for (int i = 0; i < m_pending.size(); ++i) {
+        if (m_pending[i].key == key && m_pending[i].startSecs == startSecs && m_pending[i].endSecs == endSecs) {
+            m_pending.removeAt(i);
+            break;
+        }
+    }
+}
+
+void HistoryFetchCache::insertLocked(const QString& key, const Entry& entry)
+{
+    QList<Entry>& list = m_entries[key];
+
+    // 新时间段覆盖的旧时间段不再需要
+    for (int i = list.size() - 1; i >= 0; --i) {
+        if (entry.startSecs <= list[i].startSecs && entry.endSecs >= list[i].endSecs) {
+            m_stats.cachedPoints -= list[i].points;
+            --m_stats.entries;
+            list.removeAt(i);
+        }
+    }
+
+    list.append(entry);
+    m_stats.cachedPoints += entry.points;
+    ++m_stats.entries;
+
+    evictLocked();
+}
+
+void HistoryFetchCache::evictLocked()
+{
+    while (m_stats.cachedPoints > m_maxPoints && m_stats.entries > 1) {
+        // 找最久未使用的一项
+        QString oldestKey;
+        int oldestIndex = -1;
+        quint64 oldestUse = ~0ULL;
+        for (auto it = m_entries.constBegin(); it != m_entries.constEnd(); ++it) {
+            for (int i = 0; i < it.value().size(); ++i) {
+                if (it.value()[i].lastUsed < oldestUse) {
+                    oldestUse = it.value()[i].lastUsed;
+                    oldestKey = it.key();
+                    oldestIndex = i;
+                }
+            }
+        }
+        if (oldestIndex < 0) break;
+
+        QList<Entry>& list = m_entries[oldestKey];
+        m_stats.cachedPoints -= list[oldestIndex].points;
+        --m_stats.entries;
+        ++m_stats.evictions;
+        list.removeAt(oldestIndex);
+        if (list.isEmpty()) {
+            m_entries.remove(oldestKey);
+        }
+    }
+}
+
+HistoryFetchCache::Stats HistoryFetchCache::stats() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_stats;
+}
+
+void HistoryFetchCache::clear()
+{
+    QMutexLocker locker(&m_mutex);
+    m_entries.clear();
+    m_stats.cachedPoints = 0;
+    m_stats.entries = 0;
+}
+
+void HistoryFetchCache::setMaxPoints(qint64 maxPoints)
+{
+    QMutexLocker locker(&m_mutex);
+    m_maxPoints = maxPoints;
+    evictLocked();
+}
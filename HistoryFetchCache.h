@@ -0,0 +1,86 @@
+#pragma once
+#ifndef HISTORYFETCHCACHE_H
+#define HISTORYFETCHCACHE_H
+
+#include <QString>
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QDateTime>
+#include <map>
+#include <vector>
+#include <memory>
+#include <cstdint>
+
+#include "DataBindingConfig.h"
+
+class TaosDataFetcher;
+
+// 多个报表共用的历史查询缓存（线程安全）
+// - 按 (RTU, 间隔) 保存已查询的时间段，新请求被已有时间段包含时直接截取，不再查库
+// - 同一 RTU/间隔正在查询且能覆盖新请求时，等待其完成后复用
+// - 超过容量按最久未使用淘汰
+class HistoryFetchCache
+{
+public:
+    typedef std::map<int64_t, std::vector<float>> SeriesData;
+
+    struct Stats {
+        qint64 requests = 0;
+        qint64 hits = 0;            // 完全命中（含范围包含）
+        qint64 waits = 0;           // 等待并复用正在进行的查询
+        qint64 misses = 0;          // 实际查库
+        qint64 evictions = 0;
+        qint64 cachedPoints = 0;
+        int entries = 0;
+    };
+
+    explicit HistoryFetchCache(qint64 maxPoints = 20 * 1000 * 1000);
+
+    // 取 rtuId 在 timeRange 内的原始数据；未命中时用 fetcher 查询并缓存，查询异常原样抛出
+    SeriesData fetch(TaosDataFetcher& fetcher, const QString& rtuId, const TimeRangeConfig& timeRange);
+
+    Stats stats() const;
+    void clear();
+
+    void setMaxPoints(qint64 maxPoints);
+
+private:
+    struct Entry {
+        qint64 startSecs;
+        qint64 endSecs;
+        std::shared_ptr<const SeriesData> data;
+        qint64 points;
+        quint64 lastUsed;
+    };
+
+    struct Pending {
+        QString key;
+        qint64 startSecs;
+        qint64 endSecs;
+    };
+
+    static QString seriesKey(const QString& rtuId, int intervalSeconds);
+    static SeriesData slice(const SeriesData& data, qint64 startSecs, qint64 endSecs);
+
+    // 以下均需持有 m_mutex
+    const Entry* findCovering(const QString& key, qint64 startSecs, qint64 endSecs);
+    bool hasCoveringPending(const QString& key, qint64 startSecs, qint64 endSecs) const;
+    void removePendingLocked(const QString& key, qint64 startSecs, qint64 endSecs);
+    void insertLocked(const QString& key, const Entry& entry);
+    void evictLocked();
+
+private:
+    mutable QMutex m_mutex;
+    QWaitCondition m_pendingDone;
+
+    QHash<QString, QList<Entry>> m_entries;
+    QList<Pending> m_pending;
+
+    qint64 m_maxPoints;
+    quint64 m_useCounter;
+    Stats m_stats;
+};
+
+#endif // HISTORYFETCHCACHE_H
@@ -0,0 +1,198 @@
+#include "HistoryFilterEngine.h"
+#include "reportdatamodel.h"
+#include <QDebug>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define HISTORY_FILTER_SSE2 1
+#include <emmintrin.h>
+#endif
+
+// ===== SelectionBitmap =====
+
+SelectionBitmap::SelectionBitmap(int size, bool value)
+    : m_words((size + 63) / 64, value ? ~0ULL : 0ULL)
+    , m_size(size)
+{
+    clearTail();
+}
+
+void SelectionBitmap::clearTail()
+{
+    if (m_size & 63) {
+        m_words.last() &= (1ULL << (m_size & 63)) - 1;
+    }
+}
+
+int SelectionBitmap::count() const
+{
+    int total = 0;
+    for (quint64 word : m_words) {
+        total += qPopulationCount(word);
+    }
+    return total;
+}
+
+void SelectionBitmap::andWith(const SelectionBitmap& other)
+{
+    const int n = qMin(m_words.size(), other.m_words.size());
+    quint64* dst = m_words.data();
+    const quint64* src = other.m_words.constData();
+    for (int i = 0; i < n; ++i) dst[i] &= src[i];
+    for (int i = n; i < m_words.size(); ++i) dst[i] = 0;
+}
+
+void SelectionBitmap::orWith(const SelectionBitmap& other)
+{
+    const int n = qMin(m_words.size(), other.m_words.size());
+    quint64* dst = m_words.data();
+    const quint64* src = other.m_words.constData();
+    for (int i = 0; i < n; ++i) dst[i] |= src[i];
+}
+
+QVector<int> SelectionBitmap::modelRows(bool includeHeader) const
+{
+    QVector<int> rows;
+    rows.reserve(count() + 1);
+    if (includeHeader) rows.append(0);
+
+    for (int w = 0; w < m_words.size(); ++w) {
+        quint64 word = m_words[w];
+        while (word) {
+            int bit = qCountTrailingZeroBits(word);
+            rows.append(w * 64 + bit + 1);
+            word &= word - 1;
+        }
+    }
+    return rows;
+}
+
+// ===== 扫描内核 =====
+
+namespace {
+
+#ifdef HISTORY_FILTER_SSE2
+    // 每次比较2个double，movemask 得到2位，64个值拼成一个位图字
+    template <typename SimdCmp, typename ScalarCmp>
+    void scanColumn(const double* v, int n, quint64* words, SimdCmp simd, ScalarCmp scalar)
+    {
+        int i = 0;
+        for (; i + 64 <= n; i += 64) {
+            quint64 word = 0;
+            for (int k = 0; k < 64; k += 2) {
+                __m128d x = _mm_loadu_pd(v + i + k);
+                word |= static_cast<quint64>(_mm_movemask_pd(simd(x))) << k;
+            }
+            words[i >> 6] = word;
+        }
+        for (; i < n; ++i) {
+            if (scalar(v[i])) words[i >> 6] |= 1ULL << (i & 63);
+        }
+    }
+
+#define FILTER_SCAN(SIMD_EXPR, SCALAR_EXPR) \
+    scanColumn(values, n, words, [&](__m128d x) { return SIMD_EXPR; }, [&](double x) { return SCALAR_EXPR; })
+#else
+    template <typename ScalarCmp>
+    void scanColumn(const double* v, int n, quint64* words, ScalarCmp scalar)
+    {
+        for (int i = 0; i < n; ++i) {
+            if (scalar(v[i])) words[i >> 6] |= 1ULL << (i & 63);
+        }
+    }
+
+#define FILTER_SCAN(SIMD_EXPR, SCALAR_EXPR) \
+    scanColumn(values, n, words, [&](double x) { return SCALAR_EXPR; })
+#endif
+
+}
+
+void HistoryFilterEngine::scan(const double* values, int n, const NumericPredicate& predicate, quint64* words)
+{
+    const double a = predicate.a;
+    const double b = predicate.b;
+#ifdef HISTORY_FILTER_SSE2
+    const __m128d va = _mm_set1_pd(a);
+    const __m128d vb = _mm_set1_pd(b);
+#endif
+
+    // 有序比较对 NaN 恒为假，无数据的点自然不会命中
+    switch (predicate.op) {
+    case NumericPredicate::Greater:
+        FILTER_SCAN(_mm_cmpgt_pd(x, va), x > a);
+        break;
+    case NumericPredicate::GreaterEqual:
+        FILTER_SCAN(_mm_cmpge_pd(x, va), x >= a);
+        break;
+    case NumericPredicate::Less:
+        FILTER_SCAN(_mm_cmplt_pd(x, va), x < a);
+        break;
+    case NumericPredicate::LessEqual:
+        FILTER_SCAN(_mm_cmple_pd(x, va), x <= a);
+        break;
+    case NumericPredicate::Equal:
+        FILTER_SCAN(_mm_cmpeq_pd(x, va), x == a);
+        break;
+    case NumericPredicate::NotEqual:
+        FILTER_SCAN(_mm_and_pd(_mm_cmpneq_pd(x, va), _mm_cmpord_pd(x, x)), !std::isnan(x) && x != a);
+        break;
+    case NumericPredicate::Between:
+        FILTER_SCAN(_mm_and_pd(_mm_cmpge_pd(x, va), _mm_cmple_pd(x, vb)), x >= a && x <= b);
+        break;
+    case NumericPredicate::Outside:
+        FILTER_SCAN(_mm_or_pd(_mm_cmplt_pd(x, va), _mm_cmpgt_pd(x, vb)), x < a || x > b);
+        break;
+    case NumericPredicate::IsMissing:
+        FILTER_SCAN(_mm_cmpunord_pd(x, x), std::isnan(x));
+        break;
+    }
+}
+
+#undef FILTER_SCAN
+
+SelectionBitmap HistoryFilterEngine::evaluate(const ReportDataModel* model, const NumericPredicate& predicate)
+{
+    const QVector<double>* column = model->historyColumnData(predicate.column);
+    if (!column) {
+        qWarning() << "数值筛选：第" << predicate.column << "列不是历史数据列";
+        return SelectionBitmap();
+    }
+
+    const int rows = model->historyPointCount();
+    SelectionBitmap bitmap(rows);
+
+    const int n = qMin(rows, column->size());
+    scan(column->constData(), n, predicate, bitmap.words());
+
+    // 数据列比时间轴短时，缺失部分按无数据处理
+    if (predicate.op == NumericPredicate::IsMissing) {
+        for (int i = n; i < rows; ++i) {
+            bitmap.words()[i >> 6] |= 1ULL << (i & 63);
+        }
+    }
+    return bitmap;
+}
+
+SelectionBitmap HistoryFilterEngine::evaluate(const ReportDataModel* model, const QVector<NumericPredicate>& predicates,
+    Combine combine)
+{
+    const int rows = model->historyPointCount();
+    if (predicates.isEmpty()) {
+        return SelectionBitmap(rows, true);
+    }
+
+    SelectionBitmap result = evaluate(model, predicates.first());
+    if (result.size() != rows) {
+        result = SelectionBitmap(rows, false);
+    }
+
+    for (int i = 1; i < predicates.size(); ++i) {
+        SelectionBitmap next = evaluate(model, predicates[i]);
+        if (combine == MatchAll) {
+            result.andWith(next);
+        } else {
+            result.orWith(next);
+        }
+    }
+    return result;
+}
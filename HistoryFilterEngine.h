@@ -0,0 +1,78 @@
+#pragma once
+#ifndef HISTORYFILTERENGINE_H
+#define HISTORYFILTERENGINE_H
+
+#include <QVector>
+#include <QtGlobal>
+
+class ReportDataModel;
+
+// 数值条件（作用于历史报表的一列对齐数据）
+struct NumericPredicate {
+    enum Op {
+        Greater,        // > a
+        GreaterEqual,   // >= a
+        Less,           // < a
+        LessEqual,      // <= a
+        Equal,          // == a
+        NotEqual,       // != a（无数据不算）
+        Between,        // a <= v <= b
+        Outside,        // v < a 或 v > b
+        IsMissing       // 无数据（NaN）
+    };
+
+    int column = 1;     // 模型列号（1 起为数据列）
+    Op op = Greater;
+    double a = 0.0;
+    double b = 0.0;
+};
+
+// 行选择位图：第 i 位对应时间轴第 i 个点（模型第 i+1 行）
+class SelectionBitmap
+{
+public:
+    SelectionBitmap() : m_size(0) {}
+    explicit SelectionBitmap(int size, bool value = false);
+
+    int size() const { return m_size; }
+    bool test(int i) const { return (m_words[i >> 6] >> (i & 63)) & 1ULL; }
+    int count() const;
+
+    void andWith(const SelectionBitmap& other);
+    void orWith(const SelectionBitmap& other);
+
+    // 选中的模型行号（升序），includeHeader 时包含第0行表头
+    QVector<int> modelRows(bool includeHeader = true) const;
+
+    quint64* words() { return m_words.data(); }
+    const quint64* words() const { return m_words.constData(); }
+    int wordCount() const { return m_words.size(); }
+
+private:
+    void clearTail();
+
+    QVector<quint64> m_words;
+    int m_size;
+};
+
+// 历史报表数值筛选：直接在对齐后的 double 列上按条件扫描（SSE2），不格式化字符串、不拷贝数据
+class HistoryFilterEngine
+{
+public:
+    enum Combine {
+        MatchAll,   // 所有条件同时满足
+        MatchAny    // 任一条件满足
+    };
+
+    // 单个条件的位图；列无效时返回空位图
+    static SelectionBitmap evaluate(const ReportDataModel* model, const NumericPredicate& predicate);
+
+    // 多个条件按 combine 合并；predicates 为空时全选
+    static SelectionBitmap evaluate(const ReportDataModel* model, const QVector<NumericPredicate>& predicates,
+        Combine combine = MatchAll);
+
+    // 对一段连续数据按条件置位（words 需预先清零，长度至少 (n+63)/64）
+    static void scan(const double* values, int n, const NumericPredicate& predicate, quint64* words);
+};
+
+#endif // HISTORYFILTERENGINE_H
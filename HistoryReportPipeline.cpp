@@ -0,0 +1,241 @@
+#include "HistoryReportPipeline.h"
+#include "reportdatamodel.h"
+#include "ShardedHistoryFetcher.h"
+#include "HistoryFetchCache.h"
+#include "PipelineTrace.h"
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QThreadPool>
+#include <QtConcurrent/QtConcurrentRun>
+#include <QDebug>
+#include <atomic>
+
+HistoryReportPipeline::HistoryReportPipeline(ReportDataModel* model)
+    : m_model(model)
+    , m_cache(nullptr)
+    , m_maxParallelFetches(4)
+    , m_canceled(false)
+    , m_fetchMs(0)
+    , m_alignMs(0)
+{
+}
+
+QString HistoryReportPipeline::buildAddress(const QString& rtuId, const TimeRangeConfig& timeRange)
+{
+    return QString("%1@%2~%3#%4")
+        .arg(rtuId)
+        .arg(timeRange.startTime.toString("yyyy-MM-dd HH:mm:ss"))
+        .arg(timeRange.endTime.toString("yyyy-MM-dd HH:mm:ss"))
+        .arg(timeRange.intervalSeconds);
+}
+
+bool HistoryReportPipeline::prepare(const TimeRangeConfig& timeRange)
+{
+    return prepare(m_model->getHistoryConfig(), timeRange);
+}
+
+bool HistoryReportPipeline::prepare(const HistoryReportConfig& config, const TimeRangeConfig& timeRange)
+{
+    TRACE_SCOPE("history.prepare");
+    m_error.clear();
+    m_canceled = false;
+    m_failedColumns.clear();
+    m_config = config;
+    m_timeRange = timeRange;
+
+    // 过滤掉空配置行
+    QVector<ReportColumnConfig> validColumns;
+    for (const auto& col : m_config.columns) {
+        if (!col.displayName.trimmed().isEmpty() && !col.rtuId.trimmed().isEmpty()) {
+            validColumns.append(col);
+        }
+    }
+
+    if (validColumns.isEmpty()) {
+        m_error = "配置中没有有效的列（名称和RTU号不能为空）";
+        return false;
+    }
+    m_config.columns = validColumns;
+
+    // 生成时间轴
+    m_timeAxis = ReportDataModel::generateTimeAxis(m_timeRange);
+    if (m_timeAxis.isEmpty()) {
+        m_error = "时间范围配置错误，无法生成时间轴。";
+        return false;
+    }
+    return true;
+}
+
+bool HistoryReportPipeline::execute(const ProgressCallback& progress)
+{
+    TRACE_SCOPE("history.execute");
+    if (m_timeAxis.isEmpty() || m_config.columns.isEmpty()) {
+        m_error = "报表尚未准备";
+        return false;
+    }
+
+    auto report = [&](int percent) {
+        if (progress && !progress(percent)) {
+            m_canceled = true;
+        }
+        return !m_canceled;
+    };
+
+    QElapsedTimer timer;
+    timer.start();
+
+    // 1. 先生成报表框架（表头和时间列），数据列随查询完成逐列填入
+    m_model->generateHistoryReport(m_config, QHash<QString, QVector<double>>(), m_timeAxis);
+    m_failedColumns.clear();
+    if (!report(10)) {
+        return false;
+    }
+
+    // 相同 RTU 只查询一次
+    QStringList rtuIds;
+    for (const ReportColumnConfig& col : m_config.columns) {
+        if (!rtuIds.contains(col.rtuId)) {
+            rtuIds.append(col.rtuId);
+        }
+    }
+
+    QVector<qint64> timeAxisSecs(m_timeAxis.size());
+    for (int i = 0; i < m_timeAxis.size(); ++i) {
+        timeAxisSecs[i] = m_timeAxis[i].toSecsSinceEpoch();
+    }
+
+    // 2. 各 RTU 在线程池中查询并立即对齐，结果放入到达队列
+    struct Arrival {
+        QString rtuId;
+        QVector<double> values;
+        QString failure;
+    };
+    QMutex queueMutex;
+    QWaitCondition arrived;
+    QVector<Arrival> queue;
+    std::atomic<bool> stop(false);
+    std::atomic<qint64> alignNs(0);
+
+    // 长时间范围按天分片并行查询（查询连接在分片间复用）
+    ShardedHistoryFetcher fetcher(m_cache);
+
+    auto fetchAndAlign = [&](const QString& rtuId) {
+        Arrival arrival;
+        arrival.rtuId = rtuId;
+
+        if (stop.load()) {
+            arrival.failure = "已取消";
+        }
+        else {
+            std::map<int64_t, std::vector<float>> data;
+            try {
+                TRACE_SCOPE("history.fetchColumn");
+                QStringList missingShards;
+                data = fetcher.fetch(rtuId, m_timeRange, &missingShards);
+                if (data.empty()) {
+                    qWarning() << "RTU无数据:" << rtuId;
+                    arrival.failure = "无数据";
+                }
+                else if (!missingShards.isEmpty()) {
+                    arrival.failure = QString("部分时段无数据: %1").arg(missingShards.join("，"));
+                }
+            }
+            catch (const std::exception& e) {
+                qWarning() << "RTU查询失败:" << rtuId << e.what();
+                arrival.failure = QString("查询失败: %1").arg(e.what());
+            }
+            catch (...) {
+                // 每个任务必须投递一个结果，否则发布循环会一直等待
+                qWarning() << "RTU查询失败:" << rtuId << "未知异常";
+                arrival.failure = "查询失败: 未知异常";
+            }
+
+            // 线性插值对齐（无数据时为 NaN 列）
+            QElapsedTimer alignTimer;
+            alignTimer.start();
+            try {
+                TRACE_SCOPE_ARG("history.alignColumn", timeAxisSecs.size());
+                arrival.values = ReportDataModel::alignSeriesWithInterpolation(data, timeAxisSecs);
+            }
+            catch (...) {
+                qWarning() << "RTU数据对齐失败:" << rtuId;
+                arrival.values.clear();
+                arrival.failure = "对齐失败";
+            }
+            alignNs += alignTimer.nsecsElapsed();
+        }
+
+        QMutexLocker locker(&queueMutex);
+        queue.append(std::move(arrival));
+        arrived.wakeAll();
+    };
+
+    QThreadPool pool;
+    pool.setMaxThreadCount(qMax(1, qMin(m_maxParallelFetches, rtuIds.size())));
+    for (const QString& rtuId : rtuIds) {
+        QtConcurrent::run(&pool, fetchAndAlign, rtuId);
+    }
+
+    // 3. 在调用线程逐列发布：先到先显示，总耗时接近最慢的单个查询
+    QHash<QString, QString> failures;
+    int received = 0;
+    while (received < rtuIds.size()) {
+        QVector<Arrival> ready;
+        {
+            QMutexLocker locker(&queueMutex);
+            if (queue.isEmpty()) {
+                arrived.wait(&queueMutex, 50);   // 超时也回调进度，保持界面响应
+            }
+            ready.swap(queue);
+        }
+
+        for (Arrival& arrival : ready) {
+            if (!arrival.failure.isEmpty()) {
+                failures.insert(arrival.rtuId, arrival.failure);
+            }
+            m_model->setHistoryColumnData(arrival.rtuId, arrival.values);
+            ++received;
+        }
+
+        if (!report(10 + received * 85 / rtuIds.size())) {
+            // 已发出的查询无法中断，等待结束后返回；已发布的列保留在报表中
+            stop = true;
+            pool.waitForDone();
+            return false;
+        }
+    }
+    pool.waitForDone();
+
+    m_fetchMs = timer.elapsed();
+    m_alignMs = alignNs.load() / 1000000;
+
+    for (const ReportColumnConfig& col : m_config.columns) {
+        auto it = failures.constFind(col.rtuId);
+        if (it != failures.constEnd()) {
+            m_failedColumns.append(QString("%1 (%2)").arg(col.displayName).arg(it.value()));
+        }
+    }
+    report(100);
+
+    qDebug() << "历史报表生成：" << pointCount() << "行 ×" << m_config.columns.size() << "列，查询（含逐列对齐和发布）"
+        << m_fetchMs << "ms，对齐累计" << m_alignMs << "ms";
+    return true;
+}
+
+void HistoryReportPipeline::publish(const QHash<QString, QVector<double>>& alignedData,
+    const QHash<QString, QString>& failures)
+{
+    TRACE_SCOPE("history.publish");
+    m_failedColumns.clear();
+    for (const ReportColumnConfig& col : m_config.columns) {
+        auto it = failures.constFind(col.rtuId);
+        if (it != failures.constEnd()) {
+            m_failedColumns.append(QString("%1 (%2)").arg(col.displayName).arg(it.value()));
+        }
+    }
+
+    m_fetchMs = 0;
+    m_alignMs = 0;
+    m_model->generateHistoryReport(m_config, alignedData, m_timeAxis);
+}
@@ -0,0 +1,81 @@
+#pragma once
+#ifndef HISTORYREPORTPIPELINE_H
+#define HISTORYREPORTPIPELINE_H
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QDateTime>
+#include <functional>
+
+#include "DataBindingConfig.h"
+
+class ReportDataModel;
+class HistoryFetchCache;
+
+// 历史报表生成流程：过滤配置 → 生成时间轴 → 逐列查询 → 时间对齐 → 写入模型
+// 不依赖任何界面，界面（MainWindow）和批处理（--batch）共用
+class HistoryReportPipeline
+{
+public:
+    // 进度回调：percent 为 0~100，返回 false 表示取消
+    typedef std::function<bool(int percent)> ProgressCallback;
+
+    explicit HistoryReportPipeline(ReportDataModel* model);
+
+    // 多个报表共用查询缓存（可选，不转移所有权）
+    void setFetchCache(HistoryFetchCache* cache) { m_cache = cache; }
+
+    // 同时进行的 RTU 查询数（默认 4）
+    void setMaxParallelFetches(int count) { m_maxParallelFetches = qMax(1, count); }
+
+    // 第一步：按模型当前的报表配置和给定时间范围准备；失败时见 errorString()
+    bool prepare(const TimeRangeConfig& timeRange);
+    // 使用给定配置准备（多报表生成时配置已预先读取）
+    bool prepare(const HistoryReportConfig& config, const TimeRangeConfig& timeRange);
+
+    // 第二步：查询、对齐并生成报表；被取消或没有任何有效列时返回 false
+    // 报表框架先写入模型，各 RTU 查询完成后立即对齐并逐列发布（列级 dataChanged）
+    // 进度回调在调用线程执行，取消时已发布的列保留
+    bool execute(const ProgressCallback& progress = ProgressCallback());
+
+    // 第二步（替代 execute）：用外部已对齐的数据直接生成报表，数据按 RTU 号取用且隐式共享、不拷贝
+    // failures 为各 RTU 的失败原因，用于汇总本报表的缺失列
+    void publish(const QHash<QString, QVector<double>>& alignedData,
+        const QHash<QString, QString>& failures = QHash<QString, QString>());
+
+    // 过滤空行后的有效配置
+    const HistoryReportConfig& config() const { return m_config; }
+
+    int pointCount() const { return m_timeAxis.size(); }
+    int columnCount() const { return m_config.columns.size(); }
+    const TimeRangeConfig& timeRange() const { return m_timeRange; }
+
+    QString errorString() const { return m_error; }
+    bool wasCanceled() const { return m_canceled; }
+
+    // 查询失败或无数据的列（"名称 (原因)"）
+    const QStringList& failedColumns() const { return m_failedColumns; }
+
+    qint64 fetchMs() const { return m_fetchMs; }
+    qint64 alignMs() const { return m_alignMs; }
+
+    // 查询地址格式：RTU@起始~终止#间隔
+    static QString buildAddress(const QString& rtuId, const TimeRangeConfig& timeRange);
+
+private:
+    ReportDataModel* m_model;
+    HistoryFetchCache* m_cache;
+    int m_maxParallelFetches;
+    HistoryReportConfig m_config;
+    TimeRangeConfig m_timeRange;
+    QVector<QDateTime> m_timeAxis;
+
+    QString m_error;
+    bool m_canceled;
+    QStringList m_failedColumns;
+    qint64 m_fetchMs;
+    qint64 m_alignMs;
+};
+
+#endif // HISTORYREPORTPIPELINE_H
@@ -0,0 +1,139 @@
+#include "HistorySortEngine.h"
+#include "reportdatamodel.h"
+#include <QtConcurrent>
+#include <QThread>
+#include <QElapsedTimer>
+#include <QDebug>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+
+    struct SortKey {
+        double value;
+        int row;      // 模型行号
+    };
+
+    // 每段至少这么多元素才值得并行
+    const int kMinParallelChunk = 32768;
+
+    // 分段稳定排序 + 逐轮两两归并；归并只合并相邻段，整体仍然稳定
+    template <typename Compare>
+    void parallelStableSort(QVector<SortKey>& keys, Compare less)
+    {
+        const int n = keys.size();
+        const int parts = qMin(QThread::idealThreadCount(), n / kMinParallelChunk);
+        SortKey* data = keys.data();
+
+        if (parts <= 1) {
+            std::stable_sort(data, data + n, less);
+            return;
+        }
+
+        QVector<int> bounds;
+        for (int i = 0; i <= parts; ++i) {
+            bounds.append(static_cast<int>(static_cast<qint64>(n) * i / parts));
+        }
+
+        QVector<QPair<int, int>> ranges;
+        for (int i = 0; i < parts; ++i) {
+            ranges.append(qMakePair(bounds[i], bounds[i + 1]));
+        }
+        QtConcurrent::blockingMap(ranges, [data, less](const QPair<int, int>& range) {
+            std::stable_sort(data + range.first, data + range.second, less);
+        });
+
+        // 每轮把相邻两段合并为一段
+        while (bounds.size() > 2) {
+            QVector<int> merges;     // 参与合并的左段下标
+            QVector<int> next;
+            for (int i = 0; i + 1 < bounds.size(); i += 2) {
+                next.append(bounds[i]);
+                if (i + 2 < bounds.size()) {
+                    merges.append(i);
+                }
+            }
+            next.append(bounds.last());
+
+            QtConcurrent::blockingMap(merges, [data, less, &bounds](const int& i) {
+                std::inplace_merge(data + bounds[i], data + bounds[i + 1], data + bounds[i + 2], less);
+            });
+            bounds = next;
+        }
+    }
+
+}
+
+QVector<int> HistorySortEngine::sortedRows(const ReportDataModel* model, int column, Qt::SortOrder order,
+    const QVector<int>& rows)
+{
+    const int points = model->historyPointCount();
+    if (points == 0) return QVector<int>();
+
+    // 排序键来源：时间列用秒值，数据列用对齐数据
+    const QVector<qint64>* times = nullptr;
+    const QVector<double>* values = nullptr;
+    if (column == 0) {
+        times = &model->timeAxisSeconds();
+    } else {
+        values = model->historyColumnData(column);
+        if (!values) return QVector<int>();
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+
+    QVector<SortKey> keys;
+    QVector<int> missing;      // 无数据的行，保持原顺序
+    QVector<int> others;       // 时间轴以外的行
+    bool hasHeader = false;
+
+    auto addRow = [&](int row) {
+        int index = row - 1;
+        if (row == 0) {
+            hasHeader = true;
+        } else if (index < 0 || index >= points) {
+            others.append(row);
+        } else {
+            double v;
+            if (times) {
+                v = index < times->size() ? static_cast<double>(times->at(index)) : std::numeric_limits<double>::quiet_NaN();
+            } else {
+                v = index < values->size() ? values->at(index) : std::numeric_limits<double>::quiet_NaN();
+            }
+            if (std::isnan(v)) {
+                missing.append(row);
+            } else {
+                keys.append({ v, row });
+            }
+        }
+    };
+
+    if (rows.isEmpty()) {
+        keys.reserve(points);
+        hasHeader = true;
+        // 数据以外的行（模型至少保留100行，以及用户的公式/汇总行）保持原顺序排在最后
+        const int totalRows = qMax(points + 1, model->rowCount());
+        for (int row = 1; row < totalRows; ++row) addRow(row);
+    } else {
+        keys.reserve(rows.size());
+        for (int row : rows) addRow(row);
+    }
+
+    if (order == Qt::AscendingOrder) {
+        parallelStableSort(keys, [](const SortKey& a, const SortKey& b) { return a.value < b.value; });
+    } else {
+        parallelStableSort(keys, [](const SortKey& a, const SortKey& b) { return b.value < a.value; });
+    }
+
+    QVector<int> result;
+    result.reserve(keys.size() + missing.size() + others.size() + 1);
+    if (hasHeader) result.append(0);
+    for (const SortKey& key : keys) result.append(key.row);
+    result += missing;
+    result += others;
+
+    qDebug() << "历史报表排序：" << keys.size() << "行，第" << column << "列，耗时" << timer.elapsed() << "ms";
+    return result;
+}
@@ -0,0 +1,24 @@
+#pragma once
+#ifndef HISTORYSORTENGINE_H
+#define HISTORYSORTENGINE_H
+
+#include <QVector>
+#include <Qt>
+
+class ReportDataModel;
+
+// 历史报表行排序：在列式数据上生成行号排列，不调用 data()、不拷贝数据
+// - 按数值键稳定排序，相等的行保持原有先后
+// - 无数据（NaN）的行无论升降序都排在最后
+// - 数据量较大时分段并行排序后归并
+class HistorySortEngine
+{
+public:
+    // 对 rows（模型行号，为空表示全部数据行）按 column 排序，返回新的模型行号顺序
+    // 表头行（第0行）和时间轴以外的行保持原位置关系：表头在前，其余追加在末尾
+    // column 不是时间列或历史数据列时返回空
+    static QVector<int> sortedRows(const ReportDataModel* model, int column, Qt::SortOrder order,
+        const QVector<int>& rows = QVector<int>());
+};
+
+#endif // HISTORYSORTENGINE_H
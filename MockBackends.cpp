@@ -0,0 +1,270 @@
+#include "MockBackends.h"
+#include <QDateTime>
+#include <QStringList>
+#include <QThread>
+#include <QDebug>
+#include <stdexcept>
+#include <cmath>
+#include <atomic>
+
+static const double kTwoPi = 6.283185307179586;
+
+// ===== 参数 =====
+
+MockBackendOptions MockBackendOptions::fromString(const QString& text)
+{
+    MockBackendOptions options;
+    const QStringList items = text.split(',', Qt::SkipEmptyParts);
+    for (const QString& item : items) {
+        const QString key = item.section('=', 0, 0).trimmed().toLower();
+        const QString value = item.section('=', 1).trimmed();
+
+        if (key == "latency") options.latencyMs = qMax(0, value.toInt());
+        else if (key == "jitter") options.latencyJitterMs = qMax(0, value.toInt());
+        else if (key == "concurrency") options.maxConcurrent = qMax(0, value.toInt());
+        else if (key == "rate") options.itemsPerSecond = qMax(0.0, value.toDouble());
+        else if (key == "errors") options.errorRate = qBound(0.0, value.toDouble(), 1.0);
+        else if (key == "empty") options.emptyRate = qBound(0.0, value.toDouble(), 1.0);
+        else if (key == "gaps") options.gapRate = qBound(0.0, value.toDouble(), 1.0);
+        else if (key == "seed") options.seed = value.toUInt();
+        else qWarning() << "未知的模拟后端参数:" << key;
+    }
+    return options;
+}
+
+MockBackendOptions MockBackendOptions::fromEnvironment()
+{
+    return fromString(qEnvironmentVariable("SCADA_MOCK_OPTIONS"));
+}
+
+// ===== 延迟、并发和错误注入 =====
+
+MockBackendThrottle::MockBackendThrottle(const MockBackendOptions& options)
+    : m_options(options)
+    , m_nextFreeNs(0)
+{
+    if (m_options.maxConcurrent > 0) {
+        m_slots.reset(new QSemaphore(m_options.maxConcurrent));
+    }
+    m_clock.start();
+}
+
+std::shared_ptr<MockBackendThrottle> MockBackendThrottle::sharedHistory()
+{
+    static std::shared_ptr<MockBackendThrottle> throttle =
+        std::make_shared<MockBackendThrottle>(MockBackendOptions::fromEnvironment());
+    return throttle;
+}
+
+std::shared_ptr<MockBackendThrottle> MockBackendThrottle::sharedRtdb()
+{
+    static std::shared_ptr<MockBackendThrottle> throttle =
+        std::make_shared<MockBackendThrottle>(MockBackendOptions::fromEnvironment());
+    return throttle;
+}
+
+void MockBackendThrottle::enter(qint64 items, double jitter)
+{
+    if (m_slots) m_slots->acquire();
+
+    double delayMs = m_options.latencyMs + jitter * m_options.latencyJitterMs;
+
+    // 吞吐上限对所有连接合计生效：本请求排在已占用的服务时间之后
+    if (m_options.itemsPerSecond > 0) {
+        const qint64 serviceNs = static_cast<qint64>(items * 1e9 / m_options.itemsPerSecond);
+        QMutexLocker locker(&m_rateMutex);
+        const qint64 now = m_clock.nsecsElapsed();
+        const qint64 start = qMax(now, m_nextFreeNs);
+        m_nextFreeNs = start + serviceNs;
+        delayMs += (m_nextFreeNs - now) / 1e6;
+    }
+
+    if (delayMs > 0) {
+        QThread::usleep(static_cast<unsigned long>(delayMs * 1000.0));
+    }
+}
+
+void MockBackendThrottle::leave()
+{
+    if (m_slots) m_slots->release();
+}
+
+MockRandomStream::MockRandomStream(quint32 seed)
+    : m_random(seed)
+{
+}
+
+double MockRandomStream::draw()
+{
+    QMutexLocker locker(&m_mutex);
+    return m_random.generateDouble();
+}
+
+namespace {
+
+    // 退出作用域时归还并发名额
+    class ThrottleGuard
+    {
+    public:
+        explicit ThrottleGuard(MockBackendThrottle& throttle) : m_throttle(throttle) {}
+        ~ThrottleGuard() { m_throttle.leave(); }
+    private:
+        MockBackendThrottle& m_throttle;
+    };
+
+    quint32 hashString(const std::string& text)
+    {
+        // FNV-1a，跨平台结果一致
+        quint32 hash = 2166136261u;
+        for (unsigned char c : text) {
+            hash = (hash ^ c) * 16777619u;
+        }
+        return hash;
+    }
+
+    // 每个后端实例一个随机流：种子按创建顺序错开，整体仍可复现
+    quint32 nextStreamSeed(quint32 seed)
+    {
+        static std::atomic<quint32> instances(0);
+        return seed + 0x9e3779b9u * ++instances;
+    }
+
+    // 由种子和时间戳得到 [0,1) 的确定性噪声
+    double noise(quint32 seed, int64_t secs)
+    {
+        quint64 x = (static_cast<quint64>(seed) << 32) ^ static_cast<quint64>(secs);
+        x ^= x >> 33;
+        x *= 0xff51afd7ed558ccdULL;
+        x ^= x >> 33;
+        x *= 0xc4ceb9fe1a85ec53ULL;
+        x ^= x >> 33;
+        return (x >> 11) * (1.0 / 9007199254740992.0);
+    }
+
+    double seriesValue(quint32 hash, int64_t secs)
+    {
+        const double base = 20.0 + hash % 200;
+        const double amplitude = 1.0 + (hash >> 8) % 20;
+        const double period = 3600.0 * (1 + (hash >> 16) % 24);
+        const double phase = (hash % 360) * kTwoPi / 360.0;
+        return base + amplitude * std::sin(kTwoPi * secs / period + phase) + (noise(hash, secs) - 0.5);
+    }
+
+}
+
+// ===== 模拟历史库 =====
+
+MockHistoryBackend::MockHistoryBackend(std::shared_ptr<MockBackendThrottle> throttle)
+    : m_throttle(throttle ? throttle : MockBackendThrottle::sharedHistory())
+    , m_random(nextStreamSeed(m_throttle->options().seed))
+{
+}
+
+float MockHistoryBackend::valueAt(const std::string& ycno, int64_t secs)
+{
+    return static_cast<float>(seriesValue(hashString(ycno), secs));
+}
+
+std::map<int64_t, std::vector<float>> MockHistoryBackend::read(const std::vector<std::string>& ycnoList,
+    const std::string& startTime, const std::string& endTime, int interval)
+{
+    const QDateTime start = QDateTime::fromString(QString::fromStdString(startTime), "yyyy-MM-dd HH:mm:ss");
+    const QDateTime end = QDateTime::fromString(QString::fromStdString(endTime), "yyyy-MM-dd HH:mm:ss");
+    if (!start.isValid() || !end.isValid() || ycnoList.empty()) {
+        throw std::runtime_error("模拟历史库：查询参数无效");
+    }
+    if (interval <= 0) interval = 5;
+
+    // 与 TDengine INTERVAL 窗口一致，时间点对齐到间隔的整数倍
+    const int64_t startSecs = start.toSecsSinceEpoch();
+    const int64_t endSecs = end.toSecsSinceEpoch();
+    const int64_t first = ((startSecs + interval - 1) / interval) * interval;
+    const int64_t points = first <= endSecs ? (endSecs - first) / interval + 1 : 0;
+
+    m_throttle->enter(points * static_cast<int64_t>(ycnoList.size()), m_random.draw() * 2.0 - 1.0);
+    ThrottleGuard guard(*m_throttle);
+    if (m_random.draw() < m_throttle->options().errorRate) {
+        throw std::runtime_error("模拟历史库：注入的查询失败");
+    }
+
+    std::map<int64_t, std::vector<float>> result;
+    if (m_random.draw() < m_throttle->options().emptyRate) {
+        return result;
+    }
+
+    std::vector<quint32> hashes;
+    for (const std::string& ycno : ycnoList) {
+        hashes.push_back(hashString(ycno));
+    }
+
+    const double gapRate = m_throttle->options().gapRate;
+    for (int64_t ts = first; ts <= endSecs; ts += interval) {
+        // 缺数由时间戳决定，同一时段重复查询结果一致
+        if (gapRate > 0 && noise(hashes[0] ^ 0x9e3779b9u, ts) < gapRate) {
+            continue;
+        }
+
+        std::vector<float> values;
+        values.reserve(hashes.size());
+        for (quint32 hash : hashes) {
+            values.push_back(static_cast<float>(seriesValue(hash, ts)));
+        }
+        result.emplace_hint(result.end(), ts, std::move(values));
+    }
+    return result;
+}
+
+// ===== 模拟实时库 =====
+
+MockRtdbBackend::MockRtdbBackend(std::shared_ptr<MockBackendThrottle> throttle)
+    : m_throttle(throttle ? throttle : MockBackendThrottle::sharedRtdb())
+    , m_random(nextStreamSeed(m_throttle->options().seed))
+{
+}
+
+int MockRtdbBackend::readFields(RDB_FIELD_STRU* fields, int count, RtdbValue* values)
+{
+    m_throttle->enter(count, m_random.draw() * 2.0 - 1.0);
+    ThrottleGuard guard(*m_throttle);
+    if (m_random.draw() < m_throttle->options().errorRate) {
+        return -1;
+    }
+
+    const int64_t now = QDateTime::currentSecsSinceEpoch();
+    const double emptyRate = m_throttle->options().emptyRate;
+    int responded = 0;
+
+    for (int i = 0; i < count; ++i) {
+        if (m_random.draw() < emptyRate) {
+            continue;   // 模拟无响应
+        }
+
+        const std::string field = fields[i].fldname;
+        const std::string key = std::string(fields[i].tabname) + '/' + fields[i].objname + '/' + field;
+        const quint32 hash = hashString(key);
+
+        const QString lower = QString::fromStdString(field).toLower();
+        RtdbValue::Type type = RtdbValue::Real;
+        if (lower.contains("name") || lower.contains("desc")) {
+            type = RtdbValue::Text;
+        }
+        else if (lower.contains("status") || lower.contains("state") || lower.contains("flag")) {
+            type = RtdbValue::Integer;
+        }
+
+        switch (type) {
+        case RtdbValue::Text:
+            values[i] = RtdbValue::fromText(QString::fromLocal8Bit(fields[i].objname));
+            break;
+        case RtdbValue::Integer:
+            // 状态量约每10分钟可能翻转一次
+            values[i] = RtdbValue::fromInteger(noise(hash, now / 600) < 0.5 ? 0 : 1);
+            break;
+        default:
+            values[i] = RtdbValue::fromReal(seriesValue(hash, now));
+            break;
+        }
+        ++responded;
+    }
+    return responded;
+}
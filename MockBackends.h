@@ -0,0 +1,106 @@
+#pragma once
+#ifndef MOCKBACKENDS_H
+#define MOCKBACKENDS_H
+
+#include <QString>
+#include <QMutex>
+#include <QSemaphore>
+#include <QElapsedTimer>
+#include <QRandomGenerator>
+#include <memory>
+
+#include "HistoryBackend.h"
+#include "RtdbBackend.h"
+
+// 模拟后端参数，可由环境变量 SCADA_MOCK_OPTIONS 设置，例如：
+//   latency=20,jitter=5,concurrency=4,rate=200000,errors=0.01,empty=0.01,gaps=0.002,seed=7
+struct MockBackendOptions {
+    int latencyMs = 20;             // 每次请求的基础延迟
+    int latencyJitterMs = 5;        // 延迟随机波动（±毫秒）
+    int maxConcurrent = 0;          // 同时处理的请求数上限，0 不限
+    double itemsPerSecond = 0.0;    // 吞吐上限：请求额外耗时 = 数据量 / 速率，0 不限
+    double errorRate = 0.0;         // 整个请求失败的概率
+    double emptyRate = 0.0;         // 历史：返回空数据的概率；实时：单个字段无响应的概率
+    double gapRate = 0.0;           // 历史：单个采样点缺失的概率（按时间戳确定，可复现）
+    quint32 seed = 1;
+
+    static MockBackendOptions fromString(const QString& text);
+    static MockBackendOptions fromEnvironment();
+};
+
+// 模拟服务端的容量：并发上限和总吞吐（线程安全）
+// 同一类后端的所有实例（每个查询连接一个）共用一个，限制的是整个进程对该服务的负载
+class MockBackendThrottle
+{
+public:
+    explicit MockBackendThrottle(const MockBackendOptions& options);
+
+    // 进程级共用实例，参数取自环境变量
+    static std::shared_ptr<MockBackendThrottle> sharedHistory();
+    static std::shared_ptr<MockBackendThrottle> sharedRtdb();
+
+    const MockBackendOptions& options() const { return m_options; }
+
+    // 占用并发名额并模拟耗时；jitter 为 [-1,1) 的随机数，由调用方的随机流提供
+    void enter(qint64 items, double jitter);
+    void leave();
+
+private:
+    MockBackendOptions m_options;
+    std::unique_ptr<QSemaphore> m_slots;
+
+    // 吞吐上限：按数据量排队占用服务端时间
+    QMutex m_rateMutex;
+    QElapsedTimer m_clock;
+    qint64 m_nextFreeNs;
+};
+
+// 每个后端实例独立的随机流（种子 + 实例序号），错误/空结果注入互不重复
+class MockRandomStream
+{
+public:
+    explicit MockRandomStream(quint32 seed);
+
+    double draw();   // [0,1)，线程安全
+
+private:
+    QMutex m_mutex;
+    QRandomGenerator m_random;
+};
+
+// 模拟历史库：每个 YCNO 一条确定的带噪声周期曲线，时间点按间隔对齐到整点
+class MockHistoryBackend : public HistoryBackend
+{
+public:
+    explicit MockHistoryBackend(std::shared_ptr<MockBackendThrottle> throttle = MockBackendThrottle::sharedHistory());
+
+    const char* name() const override { return "mock"; }
+
+    std::map<int64_t, std::vector<float>> read(const std::vector<std::string>& ycnoList,
+        const std::string& startTime, const std::string& endTime, int interval) override;
+
+    // 某个测点在某时刻的值（供校验）
+    static float valueAt(const std::string& ycno, int64_t secs);
+
+private:
+    std::shared_ptr<MockBackendThrottle> m_throttle;
+    MockRandomStream m_random;
+};
+
+// 模拟实时库：按 表/对象/字段 生成确定的、随时间缓慢变化的值
+// 字段名含 name/desc 的为文本，含 status/state/flag 的为整数，其余为实数
+class MockRtdbBackend : public RtdbBackend
+{
+public:
+    explicit MockRtdbBackend(std::shared_ptr<MockBackendThrottle> throttle = MockBackendThrottle::sharedRtdb());
+
+    QString name() const override { return "mock"; }
+
+    int readFields(RDB_FIELD_STRU* fields, int count, RtdbValue* values) override;
+
+private:
+    std::shared_ptr<MockBackendThrottle> m_throttle;
+    MockRandomStream m_random;
+};
+
+#endif // MOCKBACKENDS_H
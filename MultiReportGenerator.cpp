@@ -0,0 +1,182 @@
+#include "MultiReportGenerator.h"
+#include "HistoryReportPipeline.h"
+#include "HistoryFetchCache.h"
+#include "BatchReportRunner.h"
+#include "ShardedHistoryFetcher.h"
+#include "reportdatamodel.h"
+#include <QtConcurrent>
+#include <QThreadPool>
+#include <QMutex>
+#include <QSet>
+#include <QFileInfo>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QDebug>
+
+MultiReportGenerator::MultiReportGenerator(const TimeRangeConfig& timeRange)
+    : m_timeRange(timeRange)
+    , m_cache(nullptr)
+    , m_maxParallelFetches(4)
+{
+}
+
+bool MultiReportGenerator::addConfig(const QString& filePath, QString& error)
+{
+    // 只借用模型读取配置，生成阶段再逐个报表写入
+    ReportDataModel model;
+    model.setWorkMode(ReportDataModel::HISTORY_MODE);
+    if (!model.loadReportConfig(filePath)) {
+        error = QString("配置文件格式错误：%1").arg(filePath);
+        return false;
+    }
+
+    HistoryReportPipeline pipeline(&model);
+    if (!pipeline.prepare(m_timeRange)) {
+        error = QString("%1：%2").arg(filePath).arg(pipeline.errorString());
+        return false;
+    }
+
+    m_reports.append({ filePath, pipeline.config() });
+    return true;
+}
+
+QStringList MultiReportGenerator::uniqueRtuIds() const
+{
+    QStringList ids;
+    QSet<QString> seen;
+    for (const ReportEntry& report : m_reports) {
+        for (const ReportColumnConfig& col : report.config.columns) {
+            if (!seen.contains(col.rtuId)) {
+                seen.insert(col.rtuId);
+                ids.append(col.rtuId);
+            }
+        }
+    }
+    return ids;
+}
+
+// 并行查询去重后的测点，返回各 RTU 的失败原因
+QHash<QString, QString> MultiReportGenerator::fetchAll(const QStringList& rtuIds,
+    QHash<QString, std::map<int64_t, std::vector<float>>>& rawData)
+{
+    QHash<QString, QString> failures;
+    QMutex mutex;
+
+    // 长时间范围按天分片并行查询，分片经共用缓存
+    ShardedHistoryFetcher fetcher(m_cache);
+
+    QThreadPool pool;
+    pool.setMaxThreadCount(m_maxParallelFetches);
+
+    // 按线程数分组
+    const int groups = qMin(m_maxParallelFetches, rtuIds.size());
+    QVector<QStringList> batches(groups);
+    for (int i = 0; i < rtuIds.size(); ++i) {
+        batches[i % groups].append(rtuIds[i]);
+    }
+
+    QVector<QFuture<void>> futures;
+    for (const QStringList& batch : batches) {
+        futures.append(QtConcurrent::run(&pool, [this, batch, &fetcher, &rawData, &failures, &mutex]() {
+            for (const QString& rtuId : batch) {
+                std::map<int64_t, std::vector<float>> data;
+                QString failure;
+                try {
+                    QStringList missingShards;
+                    data = fetcher.fetch(rtuId, m_timeRange, &missingShards);
+                    if (data.empty()) {
+                        qWarning() << "RTU无数据:" << rtuId;
+                        failure = "无数据";
+                    }
+                    else if (!missingShards.isEmpty()) {
+                        failure = QString("部分时段无数据: %1").arg(missingShards.join("，"));
+                    }
+                }
+                catch (const std::exception& e) {
+                    qWarning() << "RTU查询失败:" << rtuId << e.what();
+                    failure = QString("查询失败: %1").arg(e.what());
+                }
+                catch (...) {
+                    qWarning() << "RTU查询失败:" << rtuId << "未知异常";
+                    failure = "查询失败: 未知异常";
+                }
+
+                QMutexLocker locker(&mutex);
+                rawData[rtuId] = std::move(data);
+                if (!failure.isEmpty()) {
+                    failures.insert(rtuId, failure);
+                }
+            }
+        }));
+    }
+    for (QFuture<void>& future : futures) {
+        future.waitForFinished();
+    }
+    return failures;
+}
+
+bool MultiReportGenerator::run(const QString& outputPath, Summary* summary)
+{
+    Summary result;
+    result.reports = m_reports.size();
+    for (const ReportEntry& report : m_reports) {
+        result.totalColumns += report.config.columns.size();
+    }
+
+    const QStringList rtuIds = uniqueRtuIds();
+    result.uniqueSeries = rtuIds.size();
+    if (m_reports.isEmpty() || rtuIds.isEmpty()) {
+        if (summary) *summary = result;
+        return false;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+
+    // 1. 每个测点只查询一次
+    QHash<QString, std::map<int64_t, std::vector<float>>> rawData;
+    const QHash<QString, QString> failures = fetchAll(rtuIds, rawData);
+    result.fetchMs = timer.restart();
+
+    // 2. 共用同一条时间轴，一次对齐全部测点
+    const QVector<QDateTime> timeAxis = ReportDataModel::generateTimeAxis(m_timeRange);
+    const QHash<QString, QVector<double>> alignedData =
+        ReportDataModel::alignDataWithInterpolation(rawData, timeAxis);
+    rawData.clear();
+    result.alignMs = timer.restart();
+
+    // 3. 分发给各报表并导出（同一个模型依次复用）
+    ReportDataModel model;
+    model.setWorkMode(ReportDataModel::HISTORY_MODE);
+
+    for (const ReportEntry& report : m_reports) {
+        HistoryReportPipeline pipeline(&model);
+        if (!pipeline.prepare(report.config, m_timeRange)) {
+            result.failedReports.append(QString("%1 (%2)").arg(report.config.reportName).arg(pipeline.errorString()));
+            continue;
+        }
+        pipeline.publish(alignedData, failures);
+
+        for (const QString& failed : pipeline.failedColumns()) {
+            qWarning().noquote() << QString("[%1] 数据缺失：%2").arg(report.config.reportName).arg(failed);
+        }
+
+        QString outputFile = BatchReportRunner::resolveOutputFile(outputPath, report.config.reportName, m_timeRange.startTime);
+        QDir().mkpath(QFileInfo(outputFile).absolutePath());
+        if (model.exportHistoryReportToExcel(outputFile)) {
+            ++result.succeeded;
+        }
+        else {
+            result.failedReports.append(QString("%1 (导出失败: %2)").arg(report.config.reportName).arg(outputFile));
+        }
+    }
+    result.exportMs = timer.elapsed();
+
+    qDebug().noquote() << QString("多报表生成：%1/%2 个报表，列 %3 → 去重测点 %4，查询 %5 ms，对齐 %6 ms，导出 %7 ms")
+        .arg(result.succeeded).arg(result.reports)
+        .arg(result.totalColumns).arg(result.uniqueSeries)
+        .arg(result.fetchMs).arg(result.alignMs).arg(result.exportMs);
+
+    if (summary) *summary = result;
+    return result.succeeded == result.reports;
+}
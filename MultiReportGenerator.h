@@ -0,0 +1,65 @@
+#pragma once
+#ifndef MULTIREPORTGENERATOR_H
+#define MULTIREPORTGENERATOR_H
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QHash>
+#include <map>
+#include <vector>
+#include <cstdint>
+
+#include "DataBindingConfig.h"
+
+class HistoryFetchCache;
+
+// 多报表生成：同一时间范围下的多个 #REPO_ 配置一起生成
+// - 汇总所有报表的 RTU 号，每个 (RTU, 时间范围, 间隔) 只查询和对齐一次
+// - 对齐结果按 RTU 号分发给各报表（QVector 隐式共享，不拷贝）
+// - 数据库负载随去重后的测点数增长，而不是各报表列数之和
+class MultiReportGenerator
+{
+public:
+    struct Summary {
+        int reports = 0;
+        int succeeded = 0;
+        int totalColumns = 0;       // 各报表列数之和
+        int uniqueSeries = 0;       // 实际查询的测点数
+        qint64 fetchMs = 0;
+        qint64 alignMs = 0;
+        qint64 exportMs = 0;
+        QStringList failedReports;
+    };
+
+    explicit MultiReportGenerator(const TimeRangeConfig& timeRange);
+
+    void setFetchCache(HistoryFetchCache* cache) { m_cache = cache; }
+    void setMaxParallelFetches(int count) { m_maxParallelFetches = qMax(1, count); }
+
+    // 读取一个配置文件；失败时返回 false 并给出原因
+    bool addConfig(const QString& filePath, QString& error);
+
+    int reportCount() const { return m_reports.size(); }
+    QStringList uniqueRtuIds() const;
+
+    // 查询 → 对齐 → 逐个报表生成并导出到 outputPath（文件名按报表名自动生成）
+    bool run(const QString& outputPath, Summary* summary = nullptr);
+
+private:
+    struct ReportEntry {
+        QString configFile;
+        HistoryReportConfig config;
+    };
+
+    QHash<QString, QString> fetchAll(const QStringList& rtuIds,
+        QHash<QString, std::map<int64_t, std::vector<float>>>& rawData);
+
+private:
+    TimeRangeConfig m_timeRange;
+    QVector<ReportEntry> m_reports;
+    HistoryFetchCache* m_cache;
+    int m_maxParallelFetches;
+};
+
+#endif // MULTIREPORTGENERATOR_H
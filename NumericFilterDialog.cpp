@@ -0,0 +1,156 @@
+// NumericFilterDialog.cpp
+#include "NumericFilterDialog.h"
+#include <QGridLayout>
+#include <QVBoxLayout>
+#include <QHBoxLayout>
+#include <QGroupBox>
+#include <QLabel>
+#include <QPushButton>
+#include <QDoubleValidator>
+#include <QMessageBox>
+
+NumericFilterDialog::NumericFilterDialog(const QStringList& columnNames, QWidget* parent)
+    : QDialog(parent)
+{
+    setWindowTitle("数值筛选");
+
+    QVBoxLayout* mainLayout = new QVBoxLayout(this);
+    mainLayout->setSpacing(15);
+    mainLayout->setContentsMargins(20, 20, 20, 20);
+
+    QGroupBox* conditionGroup = new QGroupBox("筛选条件");
+    QGridLayout* grid = new QGridLayout(conditionGroup);
+
+    m_rows[0] = createRow(columnNames, false);
+    m_rows[1] = createRow(columnNames, true);
+
+    m_combineCombo = new QComboBox();
+    m_combineCombo->addItem("且（同时满足）", HistoryFilterEngine::MatchAll);
+    m_combineCombo->addItem("或（满足任一）", HistoryFilterEngine::MatchAny);
+
+    for (int i = 0; i < 2; ++i) {
+        int gridRow = i * 2;
+        grid->addWidget(m_rows[i].columnCombo, gridRow, 0);
+        grid->addWidget(m_rows[i].opCombo, gridRow, 1);
+        grid->addWidget(m_rows[i].valueEdit, gridRow, 2);
+        grid->addWidget(new QLabel("至"), gridRow, 3);
+        grid->addWidget(m_rows[i].upperEdit, gridRow, 4);
+    }
+    grid->addWidget(m_combineCombo, 1, 0, 1, 2);
+    grid->setColumnStretch(0, 1);
+
+    mainLayout->addWidget(conditionGroup);
+
+    QHBoxLayout* buttonLayout = new QHBoxLayout();
+    buttonLayout->addStretch();
+    QPushButton* okBtn = new QPushButton("确定");
+    QPushButton* cancelBtn = new QPushButton("取消");
+    okBtn->setDefault(true);
+    buttonLayout->addWidget(okBtn);
+    buttonLayout->addWidget(cancelBtn);
+    mainLayout->addLayout(buttonLayout);
+
+    connect(okBtn, &QPushButton::clicked, this, &NumericFilterDialog::onAccept);
+    connect(cancelBtn, &QPushButton::clicked, this, &QDialog::reject);
+
+    updateEditability();
+}
+
+NumericFilterDialog::ConditionRow NumericFilterDialog::createRow(const QStringList& columnNames, bool optional)
+{
+    ConditionRow row;
+
+    row.columnCombo = new QComboBox();
+    if (optional) {
+        row.columnCombo->addItem("（无）", 0);
+    }
+    for (int i = 0; i < columnNames.size(); ++i) {
+        row.columnCombo->addItem(columnNames[i], i + 1);
+    }
+
+    row.opCombo = new QComboBox();
+    row.opCombo->addItem(">", NumericPredicate::Greater);
+    row.opCombo->addItem(">=", NumericPredicate::GreaterEqual);
+    row.opCombo->addItem("<", NumericPredicate::Less);
+    row.opCombo->addItem("<=", NumericPredicate::LessEqual);
+    row.opCombo->addItem("=", NumericPredicate::Equal);
+    row.opCombo->addItem("≠", NumericPredicate::NotEqual);
+    row.opCombo->addItem("介于", NumericPredicate::Between);
+    row.opCombo->addItem("不介于", NumericPredicate::Outside);
+    row.opCombo->addItem("无数据", NumericPredicate::IsMissing);
+
+    row.valueEdit = new QLineEdit();
+    row.valueEdit->setValidator(new QDoubleValidator(row.valueEdit));
+    row.upperEdit = new QLineEdit();
+    row.upperEdit->setValidator(new QDoubleValidator(row.upperEdit));
+
+    connect(row.columnCombo, QOverload<int>::of(&QComboBox::currentIndexChanged), this, &NumericFilterDialog::updateEditability);
+    connect(row.opCombo, QOverload<int>::of(&QComboBox::currentIndexChanged), this, &NumericFilterDialog::updateEditability);
+
+    return row;
+}
+
+void NumericFilterDialog::updateEditability()
+{
+    for (const ConditionRow& row : m_rows) {
+        bool active = row.columnCombo->currentData().toInt() > 0;
+        int op = row.opCombo->currentData().toInt();
+        bool ranged = (op == NumericPredicate::Between || op == NumericPredicate::Outside);
+
+        row.opCombo->setEnabled(active);
+        row.valueEdit->setEnabled(active && op != NumericPredicate::IsMissing);
+        row.upperEdit->setEnabled(active && ranged);
+    }
+    m_combineCombo->setEnabled(m_rows[1].columnCombo->currentData().toInt() > 0);
+}
+
+// 读取一行条件；未选择列时返回 false，数值非法时 ok 置为 false
+bool NumericFilterDialog::readRow(const ConditionRow& row, NumericPredicate& predicate, bool& ok) const
+{
+    ok = true;
+    predicate.column = row.columnCombo->currentData().toInt();
+    if (predicate.column <= 0) return false;
+
+    predicate.op = static_cast<NumericPredicate::Op>(row.opCombo->currentData().toInt());
+    if (predicate.op == NumericPredicate::IsMissing) return true;
+
+    predicate.a = row.valueEdit->text().toDouble(&ok);
+    if (ok && (predicate.op == NumericPredicate::Between || predicate.op == NumericPredicate::Outside)) {
+        predicate.b = row.upperEdit->text().toDouble(&ok);
+        if (ok && predicate.b < predicate.a) {
+            qSwap(predicate.a, predicate.b);
+        }
+    }
+    return true;
+}
+
+QVector<NumericPredicate> NumericFilterDialog::predicates() const
+{
+    QVector<NumericPredicate> result;
+    for (const ConditionRow& row : m_rows) {
+        NumericPredicate predicate;
+        bool ok = false;
+        if (readRow(row, predicate, ok) && ok) {
+            result.append(predicate);
+        }
+    }
+    return result;
+}
+
+HistoryFilterEngine::Combine NumericFilterDialog::combine() const
+{
+    return static_cast<HistoryFilterEngine::Combine>(m_combineCombo->currentData().toInt());
+}
+
+void NumericFilterDialog::onAccept()
+{
+    for (const ConditionRow& row : m_rows) {
+        NumericPredicate predicate;
+        bool ok = false;
+        if (readRow(row, predicate, ok) && !ok) {
+            QMessageBox::warning(this, "数值筛选", "请输入有效的数值");
+            return;
+        }
+    }
+    accept();
+}
@@ -0,0 +1,46 @@
+#pragma once
+// NumericFilterDialog.h
+#ifndef NUMERICFILTERDIALOG_H
+#define NUMERICFILTERDIALOG_H
+
+#include <QDialog>
+#include <QComboBox>
+#include <QLineEdit>
+#include <QStringList>
+#include <QVector>
+
+#include "HistoryFilterEngine.h"
+
+// 历史报表数值筛选条件对话框（最多两个条件，且/或组合）
+class NumericFilterDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    // columnNames 依次对应模型第 1、2… 列的数据列名称
+    explicit NumericFilterDialog(const QStringList& columnNames, QWidget* parent = nullptr);
+
+    QVector<NumericPredicate> predicates() const;
+    HistoryFilterEngine::Combine combine() const;
+
+private slots:
+    void updateEditability();
+    void onAccept();
+
+private:
+    struct ConditionRow {
+        QComboBox* columnCombo;
+        QComboBox* opCombo;
+        QLineEdit* valueEdit;
+        QLineEdit* upperEdit;   // 介于/不介于 时的上限
+    };
+
+    ConditionRow createRow(const QStringList& columnNames, bool optional);
+    bool readRow(const ConditionRow& row, NumericPredicate& predicate, bool& ok) const;
+
+private:
+    ConditionRow m_rows[2];
+    QComboBox* m_combineCombo;
+};
+
+#endif // NUMERICFILTERDIALOG_H
@@ -0,0 +1,213 @@
+#include "PipelineTrace.h"
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QThread>
+#include <QHash>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QJsonDocument>
+#include <QDebug>
+#include <algorithm>
+
+std::atomic<bool> PipelineTrace::s_enabled(false);
+
+namespace {
+
+    // 环形缓冲：写满后覆盖最早的事件
+    struct TraceBuffer
+    {
+        QMutex mutex;
+        QVector<PipelineTrace::Event> events;
+        int next = 0;
+        bool wrapped = false;
+        QHash<quint32, QString> threadNames;
+
+        TraceBuffer() { events.resize(65536); }
+    };
+
+    TraceBuffer& traceBuffer()
+    {
+        static TraceBuffer buffer;
+        return buffer;
+    }
+
+    std::atomic<quint32> s_nextThreadId(0);
+
+    // 线程编号从1开始，首次记录时登记线程名
+    quint32 currentThreadId()
+    {
+        thread_local quint32 id = 0;
+        if (id == 0) {
+            id = ++s_nextThreadId;
+
+            QString name;
+            QThread* thread = QThread::currentThread();
+            if (QCoreApplication::instance() && thread == QCoreApplication::instance()->thread()) {
+                name = "主线程";
+            }
+            else if (thread && !thread->objectName().isEmpty()) {
+                name = thread->objectName();
+            }
+            else {
+                name = QString("线程 %1").arg(id);
+            }
+
+            TraceBuffer& buffer = traceBuffer();
+            QMutexLocker locker(&buffer.mutex);
+            buffer.threadNames.insert(id, name);
+        }
+        return id;
+    }
+
+}
+
+void PipelineTrace::setEnabled(bool enabled)
+{
+    if (enabled) nowNs();   // 提前启动计时基准
+    s_enabled.store(enabled, std::memory_order_relaxed);
+}
+
+void PipelineTrace::setCapacity(int events)
+{
+    TraceBuffer& buffer = traceBuffer();
+    QMutexLocker locker(&buffer.mutex);
+    buffer.events = QVector<Event>(qMax(16, events));
+    buffer.next = 0;
+    buffer.wrapped = false;
+}
+
+void PipelineTrace::clear()
+{
+    TraceBuffer& buffer = traceBuffer();
+    QMutexLocker locker(&buffer.mutex);
+    buffer.next = 0;
+    buffer.wrapped = false;
+}
+
+int PipelineTrace::eventCount()
+{
+    TraceBuffer& buffer = traceBuffer();
+    QMutexLocker locker(&buffer.mutex);
+    return buffer.wrapped ? buffer.events.size() : buffer.next;
+}
+
+qint64 PipelineTrace::nowNs()
+{
+    static QElapsedTimer clock = [] {
+        QElapsedTimer timer;
+        timer.start();
+        return timer;
+    }();
+    return clock.nsecsElapsed();
+}
+
+void PipelineTrace::record(const char* name, qint64 startNs, qint64 endNs, qint64 arg, bool hasArg)
+{
+    const quint32 threadId = currentThreadId();
+
+    TraceBuffer& buffer = traceBuffer();
+    QMutexLocker locker(&buffer.mutex);
+    Event& event = buffer.events[buffer.next];
+    event.name = name;
+    event.startNs = startNs;
+    event.durationNs = endNs - startNs;
+    event.threadId = threadId;
+    event.arg = arg;
+    event.hasArg = hasArg;
+
+    if (++buffer.next == buffer.events.size()) {
+        buffer.next = 0;
+        buffer.wrapped = true;
+    }
+}
+
+QVector<PipelineTrace::Event> PipelineTrace::snapshot()
+{
+    TraceBuffer& buffer = traceBuffer();
+    QMutexLocker locker(&buffer.mutex);
+
+    QVector<Event> result;
+    if (buffer.wrapped) {
+        result.reserve(buffer.events.size());
+        for (int i = buffer.next; i < buffer.events.size(); ++i) result.append(buffer.events[i]);
+    }
+    for (int i = 0; i < buffer.next; ++i) result.append(buffer.events[i]);
+
+    // 区间在结束时写入，按开始时间重新排序
+    std::stable_sort(result.begin(), result.end(), [](const Event& a, const Event& b) {
+        return a.startNs < b.startNs;
+    });
+    return result;
+}
+
+bool PipelineTrace::writeChromeTrace(const QString& fileName, QString* error)
+{
+    const QVector<Event> events = snapshot();
+    const qint64 pid = QCoreApplication::applicationPid();
+
+    QHash<quint32, QString> threadNames;
+    {
+        TraceBuffer& buffer = traceBuffer();
+        QMutexLocker locker(&buffer.mutex);
+        threadNames = buffer.threadNames;
+    }
+
+    QJsonArray traceEvents;
+    for (auto it = threadNames.constBegin(); it != threadNames.constEnd(); ++it) {
+        QJsonObject meta;
+        meta["name"] = "thread_name";
+        meta["ph"] = "M";
+        meta["pid"] = pid;
+        meta["tid"] = static_cast<qint64>(it.key());
+        meta["args"] = QJsonObject{ { "name", it.value() } };
+        traceEvents.append(meta);
+    }
+
+    for (const Event& event : events) {
+        const QString name = QString::fromLatin1(event.name);
+
+        // 时间单位为微秒
+        QJsonObject item;
+        item["name"] = name;
+        item["cat"] = name.section('.', 0, 0);
+        item["ph"] = "X";
+        item["ts"] = event.startNs / 1000.0;
+        item["dur"] = event.durationNs / 1000.0;
+        item["pid"] = pid;
+        item["tid"] = static_cast<qint64>(event.threadId);
+        if (event.hasArg) {
+            item["args"] = QJsonObject{ { "value", event.arg } };
+        }
+        traceEvents.append(item);
+    }
+
+    QJsonObject root;
+    root["traceEvents"] = traceEvents;
+    root["displayTimeUnit"] = "ms";
+
+    QFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        if (error) *error = file.errorString();
+        return false;
+    }
+    file.write(QJsonDocument(root).toJson(QJsonDocument::Compact));
+    qDebug() << "性能跟踪已写出:" << fileName << events.size() << "个事件";
+    return true;
+}
+
+QString PipelineTrace::configureFromEnvironment()
+{
+    const QString fileName = qEnvironmentVariable("SCADA_TRACE");
+    if (!fileName.isEmpty()) {
+        bool ok = false;
+        const int capacity = qEnvironmentVariable("SCADA_TRACE_CAPACITY").toInt(&ok);
+        if (ok && capacity > 0) {
+            setCapacity(capacity);
+        }
+        setEnabled(true);
+    }
+    return fileName;
+}
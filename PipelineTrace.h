@@ -0,0 +1,84 @@
+#pragma once
+#ifndef PIPELINETRACE_H
+#define PIPELINETRACE_H
+
+#include <QString>
+#include <QVector>
+#include <atomic>
+
+// 报表流程的轻量跟踪：各阶段用 TRACE_SCOPE 记录耗时区间，写入固定容量的环形缓冲，
+// 可导出为 Chrome/Perfetto 跟踪文件（chrome://tracing 或 ui.perfetto.dev 打开）
+// 未启用时每个区间只有一次原子读；定义 SCADA_NO_TRACE 时宏完全展开为空
+class PipelineTrace
+{
+public:
+    struct Event {
+        const char* name = nullptr;     // 区间名称，必须是字符串字面量（"阶段.步骤"，点号前为分类）
+        qint64 startNs = 0;
+        qint64 durationNs = 0;
+        quint32 threadId = 0;
+        qint64 arg = 0;                 // 附加数值（行数、列数等）
+        bool hasArg = false;
+    };
+
+    static bool isEnabled() { return s_enabled.load(std::memory_order_relaxed); }
+    static void setEnabled(bool enabled);
+
+    // 环形缓冲容量（事件数），修改时清空已有记录
+    static void setCapacity(int events);
+    static void clear();
+    static int eventCount();
+
+    // 按时间先后返回缓冲中的事件
+    static QVector<Event> snapshot();
+
+    // 写出 Chrome 跟踪格式 JSON
+    static bool writeChromeTrace(const QString& fileName, QString* error = nullptr);
+
+    // 环境变量 SCADA_TRACE=<文件> 时启用，返回跟踪文件名（未设置时为空）
+    static QString configureFromEnvironment();
+
+    static qint64 nowNs();
+    static void record(const char* name, qint64 startNs, qint64 endNs, qint64 arg, bool hasArg);
+
+    // 作用域区间：构造时开始，析构时写入缓冲
+    class Scope
+    {
+    public:
+        explicit Scope(const char* name)
+            : m_name(isEnabled() ? name : nullptr), m_start(m_name ? nowNs() : 0), m_arg(0), m_hasArg(false) {}
+        Scope(const char* name, qint64 arg)
+            : m_name(isEnabled() ? name : nullptr), m_start(m_name ? nowNs() : 0), m_arg(arg), m_hasArg(true) {}
+        ~Scope()
+        {
+            if (m_name) record(m_name, m_start, nowNs(), m_arg, m_hasArg);
+        }
+
+        void setArg(qint64 arg) { m_arg = arg; m_hasArg = true; }
+
+    private:
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+        const char* m_name;
+        qint64 m_start;
+        qint64 m_arg;
+        bool m_hasArg;
+    };
+
+private:
+    static std::atomic<bool> s_enabled;
+};
+
+#define PIPELINE_TRACE_CONCAT_(a, b) a##b
+#define PIPELINE_TRACE_CONCAT(a, b) PIPELINE_TRACE_CONCAT_(a, b)
+
+#ifndef SCADA_NO_TRACE
+#define TRACE_SCOPE(name) PipelineTrace::Scope PIPELINE_TRACE_CONCAT(traceScope_, __LINE__)(name)
+#define TRACE_SCOPE_ARG(name, arg) PipelineTrace::Scope PIPELINE_TRACE_CONCAT(traceScope_, __LINE__)(name, static_cast<qint64>(arg))
+#else
+#define TRACE_SCOPE(name) ((void)0)
+#define TRACE_SCOPE_ARG(name, arg) ((void)0)
+#endif
+
+#endif // PIPELINETRACE_H
@@ -0,0 +1,168 @@
+#include "RealtimeRefreshScheduler.h"
+#include "reportdatamodel.h"
+#include <QDebug>
+
+RealtimeRefreshScheduler::RealtimeRefreshScheduler(ReportDataModel* model, QObject* parent)
+    : QObject(parent)
+    , m_model(model)
+    , m_periodMs(2000)
+    , m_tickIndex(0)
+    , m_nextIndex(0)
+    , m_running(false)
+    , m_inTick(false)
+{
+    m_timer.setSingleShot(true);
+    m_timer.setTimerType(Qt::PreciseTimer);
+    connect(&m_timer, &QTimer::timeout, this, &RealtimeRefreshScheduler::onTimeout);
+    connect(m_model, &ReportDataModel::bindingRefreshFinished,
+        this, &RealtimeRefreshScheduler::onRefreshFinished);
+}
+
+void RealtimeRefreshScheduler::setPeriod(int periodMs)
+{
+    m_periodMs = qMax(100, periodMs);
+
+    // 运行中修改周期：以当前时刻为新的时间基准
+    if (m_running) {
+        m_clock.restart();
+        m_tickIndex = 0;
+        scheduleNext();
+    }
+}
+
+void RealtimeRefreshScheduler::setRateClass(const QString& bindingKey, int divider)
+{
+    if (divider <= 1) {
+        m_rateDividers.remove(bindingKey);
+    }
+    else {
+        m_rateDividers[bindingKey] = divider;
+    }
+}
+
+void RealtimeRefreshScheduler::clearRateClasses()
+{
+    m_rateDividers.clear();
+}
+
+void RealtimeRefreshScheduler::start()
+{
+    if (m_running) return;
+
+    m_running = true;
+    m_tickIndex = 0;
+    m_nextIndex = 0;
+    m_clock.start();
+
+    // 启动时立即刷新一次，之后按周期对齐
+    onTimeout();
+}
+
+void RealtimeRefreshScheduler::stop()
+{
+    m_running = false;
+    m_inTick = false;
+    m_timer.stop();
+}
+
+void RealtimeRefreshScheduler::resetStats()
+{
+    m_stats = Stats();
+}
+
+void RealtimeRefreshScheduler::scheduleNext()
+{
+    if (!m_running) return;
+
+    // 下一次触发时间 = 起点 + n × 周期，不依赖上次触发的实际时刻
+    qint64 now = m_clock.elapsed();
+    qint64 nextIndex = m_tickIndex + 1;
+    qint64 deadline = nextIndex * m_periodMs;
+
+    if (deadline <= now) {
+        // 已经错过一个或多个周期，直接对齐到下一个未来的周期
+        qint64 catchUp = now / m_periodMs + 1;
+        m_stats.missedTicks += static_cast<quint64>(catchUp - nextIndex);
+        nextIndex = catchUp;
+        deadline = nextIndex * m_periodMs;
+    }
+
+    m_nextIndex = nextIndex;
+    m_timer.start(static_cast<int>(deadline - now));
+}
+
+void RealtimeRefreshScheduler::onTimeout()
+{
+    if (!m_running) return;
+
+    m_tickIndex = m_nextIndex;
+    qint64 lateness = m_clock.elapsed() - m_tickIndex * m_periodMs;
+    m_stats.maxLatenessMs = qMax(m_stats.maxLatenessMs, lateness);
+
+    // 上一次刷新还在进行（或被模态对话框重入），跳过本周期
+    if (m_inTick || m_model->isBindingRefreshInProgress()) {
+        ++m_stats.skippedBusy;
+        scheduleNext();
+        return;
+    }
+
+    // 查询在模型的工作线程中执行，耗时在结果返回时统计
+    quint64 requestId = 0;
+    if (m_rateDividers.isEmpty()) {
+        requestId = m_model->requestDataBindingsAsync();
+    }
+    else {
+        QSet<QString> keys = dueKeys();
+        if (!keys.isEmpty()) {
+            requestId = m_model->requestDataBindingsAsync(keys);
+        }
+    }
+    m_inTick = (requestId != 0);
+
+    scheduleNext();
+}
+
+void RealtimeRefreshScheduler::onRefreshFinished(qint64 roundTripMs, qint64 queryMs,
+    const UniversalQueryEngine::ChunkTimingList& chunkTimings)
+{
+    Q_UNUSED(queryMs);
+
+    // 手动刷新等非调度请求也会触发本信号，只统计调度器发起的
+    if (!m_inTick) return;
+    m_inTick = false;
+
+    ++m_stats.ticks;
+    m_stats.lastDurationMs = roundTripMs;
+    m_stats.maxDurationMs = qMax(m_stats.maxDurationMs, roundTripMs);
+
+    m_stats.lastChunkTimings = chunkTimings;
+    m_stats.lastChunkCount = chunkTimings.size();
+    m_stats.lastSlowestChunkMs = 0;
+    for (const UniversalQueryEngine::ChunkTiming& chunk : chunkTimings) {
+        m_stats.lastSlowestChunkMs = qMax(m_stats.lastSlowestChunkMs, chunk.elapsedMs);
+    }
+    m_stats.maxChunkMs = qMax(m_stats.maxChunkMs, m_stats.lastSlowestChunkMs);
+
+    if (roundTripMs > m_periodMs) {
+        ++m_stats.overruns;
+        qWarning() << "实时刷新超时：耗时" << roundTripMs << "ms，周期" << m_periodMs << "ms，"
+            << m_stats.lastChunkCount << "块，最慢块" << m_stats.lastSlowestChunkMs << "ms";
+        emit overrun(roundTripMs, m_periodMs);
+    }
+    emit refreshed(roundTripMs);
+}
+
+// 本周期需要刷新的绑定键：未设置等级的每周期刷新，其余按倍数抽取
+QSet<QString> RealtimeRefreshScheduler::dueKeys() const
+{
+    QSet<QString> keys;
+    const QSet<QString> allKeys = m_model->bindingKeys();
+
+    for (const QString& key : allKeys) {
+        int divider = m_rateDividers.value(key, FastRate);
+        if (m_tickIndex % divider == 0) {
+            keys.insert(key);
+        }
+    }
+    return keys;
+}
@@ -0,0 +1,86 @@
+#pragma once
+#ifndef REALTIMEREFRESHSCHEDULER_H
+#define REALTIMEREFRESHSCHEDULER_H
+
+#include <QObject>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QSet>
+#include <QString>
+#include "UniversalQueryEngine.h"
+
+class ReportDataModel;
+
+// 实时模式 ## 绑定的周期刷新调度器
+// - 按基础周期对齐到绝对时间，不累计漂移
+// - 每个绑定可指定刷新等级（每 N 个基础周期刷新一次）
+// - 查询异步执行；上一次刷新未返回时跳过本周期，并按返回耗时统计超时
+class RealtimeRefreshScheduler : public QObject
+{
+    Q_OBJECT
+
+public:
+    // 刷新等级：基础周期的倍数
+    enum RateClass {
+        FastRate = 1,
+        NormalRate = 5,
+        SlowRate = 30
+    };
+
+    struct Stats {
+        quint64 ticks = 0;            // 实际执行的刷新次数
+        quint64 skippedBusy = 0;      // 因上次刷新未完成而跳过的周期
+        quint64 missedTicks = 0;      // 因超时错过的周期
+        quint64 overruns = 0;         // 刷新耗时超过周期的次数
+        qint64 lastDurationMs = 0;
+        qint64 maxDurationMs = 0;
+        qint64 maxLatenessMs = 0;     // 实际触发时间相对计划时间的最大延迟
+        int lastChunkCount = 0;       // 最近一次查询的 RTDB 分块数
+        qint64 lastSlowestChunkMs = 0;
+        qint64 maxChunkMs = 0;        // 单个分块的最大耗时
+        UniversalQueryEngine::ChunkTimingList lastChunkTimings;   // 最近一次查询的各分块耗时
+    };
+
+    explicit RealtimeRefreshScheduler(ReportDataModel* model, QObject* parent = nullptr);
+
+    void setPeriod(int periodMs);
+    int period() const { return m_periodMs; }
+
+    void setRateClass(const QString& bindingKey, int divider);
+    void clearRateClasses();
+
+    void start();
+    void stop();
+    bool isRunning() const { return m_running; }
+
+    const Stats& stats() const { return m_stats; }
+    void resetStats();
+
+signals:
+    void refreshed(qint64 durationMs);
+    void overrun(qint64 durationMs, int periodMs);
+
+private slots:
+    void onTimeout();
+    void onRefreshFinished(qint64 roundTripMs, qint64 queryMs, const UniversalQueryEngine::ChunkTimingList& chunkTimings);
+
+private:
+    void scheduleNext();
+    QSet<QString> dueKeys() const;
+
+private:
+    ReportDataModel* m_model;
+    QTimer m_timer;
+    QElapsedTimer m_clock;
+    int m_periodMs;
+    qint64 m_tickIndex;     // 当前周期序号（相对启动时刻）
+    qint64 m_nextIndex;     // 已排定的下一个周期序号
+    bool m_running;
+    bool m_inTick;          // 调度器发起的请求尚未返回
+
+    QHash<QString, int> m_rateDividers;   // 绑定键 → 基础周期倍数
+    Stats m_stats;
+};
+
+#endif // REALTIMEREFRESHSCHEDULER_H
@@ -0,0 +1,282 @@
+#include "ReportScheduleService.h"
+#include <QtConcurrent>
+#include <QFutureWatcher>
+#include <QCommandLineParser>
+#include <QCommandLineOption>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QFile>
+#include <QFileInfo>
+#include <QDir>
+#include <QDebug>
+#include <cstring>
+
+// 检查到期任务的周期
+static const int kTickIntervalMs = 30 * 1000;
+
+ReportScheduleService::ReportScheduleService(QObject* parent)
+    : QObject(parent)
+{
+    m_pool.setMaxThreadCount(4);
+    m_tickTimer.setInterval(kTickIntervalMs);
+    connect(&m_tickTimer, &QTimer::timeout, this, &ReportScheduleService::onTick);
+    m_clock.start();
+}
+
+ReportScheduleService::~ReportScheduleService()
+{
+    m_tickTimer.stop();
+    m_pool.waitForDone();
+}
+
+bool ReportScheduleService::isServiceInvocation(int argc, char* argv[])
+{
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--service") == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool ReportScheduleService::start(const QStringList& arguments)
+{
+    QCommandLineParser parser;
+    parser.setApplicationDescription("SCADA报表控件 - 定时报表服务");
+    parser.addHelpOption();
+
+    QCommandLineOption serviceOption("service", "定时报表服务模式");
+    QCommandLineOption scheduleOption("schedule", "计划表文件（JSON）", "file");
+    parser.addOption(serviceOption);
+    parser.addOption(scheduleOption);
+    parser.process(arguments);
+
+    if (!parser.isSet(scheduleOption)) {
+        qWarning().noquote() << "用法：ScadaReportControl --service --schedule <计划表.json>";
+        return false;
+    }
+
+    QString error;
+    if (!loadSchedule(parser.value(scheduleOption), error)) {
+        qWarning().noquote() << "计划表加载失败：" << error;
+        return false;
+    }
+
+    m_tickTimer.start();
+    qDebug().noquote() << QString("定时报表服务已启动：%1 个任务，最多 %2 个并发")
+        .arg(m_jobs.size()).arg(m_pool.maxThreadCount());
+    return true;
+}
+
+bool ReportScheduleService::loadSchedule(const QString& filePath, QString& error)
+{
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        error = QString("无法打开 %1").arg(filePath);
+        return false;
+    }
+
+    QJsonParseError parseError;
+    QJsonDocument doc = QJsonDocument::fromJson(file.readAll(), &parseError);
+    if (doc.isNull() || !doc.isObject()) {
+        error = QString("JSON 格式错误：%1").arg(parseError.errorString());
+        return false;
+    }
+
+    // 相对路径按计划表所在目录解析
+    const QDir baseDir = QFileInfo(filePath).absoluteDir();
+    const QJsonObject root = doc.object();
+
+    m_pool.setMaxThreadCount(qMax(1, root.value("maxConcurrent").toInt(4)));
+    m_cache.setMaxPoints(static_cast<qint64>(root.value("cacheMaxPoints").toDouble(20 * 1000 * 1000)));
+    m_outputDir = baseDir.absoluteFilePath(root.value("outputDir").toString("."));
+    m_metricsFile = root.contains("metricsFile") ? baseDir.absoluteFilePath(root.value("metricsFile").toString()) : QString();
+    QDir().mkpath(m_outputDir);
+
+    const QDateTime now = QDateTime::currentDateTime();
+    QVector<JobSpec> jobs;
+    const QJsonArray jobArray = root.value("jobs").toArray();
+    for (int i = 0; i < jobArray.size(); ++i) {
+        const QJsonObject object = jobArray[i].toObject();
+
+        JobSpec job;
+        job.options.configFile = baseDir.absoluteFilePath(object.value("config").toString());
+        job.name = object.value("name").toString(QFileInfo(job.options.configFile).completeBaseName());
+
+        if (!TimeSettingsDialog::parseReportType(object.value("type").toString("daily"), job.options.type)
+            || job.options.type == TimeSettingsDialog::Custom) {
+            error = QString("第 %1 个任务的报表类型无效（服务只支持 daily/weekly/monthly）").arg(i + 1);
+            return false;
+        }
+
+        job.at = QTime::fromString(object.value("at").toString("00:30"), "HH:mm");
+        if (!job.at.isValid()) {
+            error = QString("第 %1 个任务的执行时刻无效").arg(i + 1);
+            return false;
+        }
+
+        job.options.intervalSeconds = object.value("interval").toInt(0);
+        job.weekday = qBound(1, object.value("weekday").toInt(1), 7);
+        job.dayOfMonth = qBound(1, object.value("day").toInt(1), 31);
+        job.options.outputPath = object.contains("output")
+            ? baseDir.absoluteFilePath(object.value("output").toString())
+            : m_outputDir + "/";
+        job.nextRun = nextRunAfter(job, now);
+        jobs.append(job);
+    }
+
+    m_jobs = jobs;
+
+    for (const JobSpec& job : m_jobs) {
+        qDebug().noquote() << QString("  任务 %1：下次执行 %2").arg(job.name).arg(job.nextRun.toString("yyyy-MM-dd HH:mm"));
+    }
+
+    if (root.value("runOnStart").toBool(false)) {
+        for (int i = 0; i < m_jobs.size(); ++i) enqueue(i);
+    }
+    return true;
+}
+
+QDateTime ReportScheduleService::nextRunAfter(const JobSpec& job, const QDateTime& now)
+{
+    const QDate today = now.date();
+
+    switch (job.options.type) {
+    case TimeSettingsDialog::Weekly: {
+        QDate date = today.addDays((job.weekday - today.dayOfWeek() + 7) % 7);
+        QDateTime candidate(date, job.at);
+        return candidate > now ? candidate : candidate.addDays(7);
+    }
+    case TimeSettingsDialog::Monthly: {
+        for (int offset = 0; offset < 2; ++offset) {
+            QDate month = QDate(today.year(), today.month(), 1).addMonths(offset);
+            QDate date(month.year(), month.month(), qMin(job.dayOfMonth, month.daysInMonth()));
+            QDateTime candidate(date, job.at);
+            if (candidate > now) return candidate;
+        }
+        return QDateTime(today.addMonths(1), job.at);
+    }
+    default: {
+        QDateTime candidate(today, job.at);
+        return candidate > now ? candidate : candidate.addDays(1);
+    }
+    }
+}
+
+void ReportScheduleService::onTick()
+{
+    const QDateTime now = QDateTime::currentDateTime();
+    for (int i = 0; i < m_jobs.size(); ++i) {
+        if (m_jobs[i].nextRun <= now) {
+            enqueue(i);
+            m_jobs[i].nextRun = nextRunAfter(m_jobs[i], now);
+        }
+    }
+}
+
+bool ReportScheduleService::enqueue(int jobIndex)
+{
+    if (jobIndex < 0 || jobIndex >= m_jobs.size()) return false;
+
+    if (m_activeJobs.contains(jobIndex)) {
+        qWarning().noquote() << "任务仍在队列或运行中，跳过本次：" << m_jobs[jobIndex].name;
+        return false;
+    }
+    m_activeJobs.insert(jobIndex);
+    ++m_metrics.submitted;
+
+    auto run = std::make_shared<JobRun>();
+    run->jobIndex = jobIndex;
+    run->queuedMs = m_clock.elapsed();
+    run->startedMs = run->queuedMs;
+    run->finishedMs = run->queuedMs;
+    run->exitCode = BatchReportRunner::Success;
+
+    // 线程池满时任务在池内排队，超出并发限制的报表等待空闲线程
+    const BatchReportOptions options = m_jobs[jobIndex].options;
+    HistoryFetchCache* cache = &m_cache;
+    const QElapsedTimer clock = m_clock;
+
+    auto* watcher = new QFutureWatcher<void>(this);
+    connect(watcher, &QFutureWatcher<void>::finished, this, [this, watcher, run]() {
+        watcher->deleteLater();
+        onJobFinished(run);
+    });
+    watcher->setFuture(QtConcurrent::run(&m_pool, [run, options, cache, clock]() {
+        run->startedMs = clock.elapsed();
+        run->exitCode = BatchReportRunner::run(options, cache, &run->result);
+        run->finishedMs = clock.elapsed();
+    }));
+    return true;
+}
+
+void ReportScheduleService::onJobFinished(const std::shared_ptr<JobRun>& run)
+{
+    m_activeJobs.remove(run->jobIndex);
+
+    const qint64 queueMs = run->startedMs - run->queuedMs;
+    const qint64 runMs = run->finishedMs - run->startedMs;
+
+    if (run->exitCode == BatchReportRunner::Success) {
+        ++m_metrics.completed;
+    }
+    else {
+        ++m_metrics.failed;
+    }
+    m_metrics.totalQueueMs += queueMs;
+    m_metrics.totalRunMs += runMs;
+    m_metrics.maxLatencyMs = qMax(m_metrics.maxLatencyMs, queueMs + runMs);
+
+    const qint64 finished = m_metrics.completed + m_metrics.failed;
+    const double uptimeHours = m_clock.elapsed() / 3600000.0;
+    const HistoryFetchCache::Stats cacheStats = m_cache.stats();
+
+    qDebug().noquote() << QString("任务 %1 结束（退出码 %2）：排队 %3 ms，执行 %4 ms；累计 %5 个，失败 %6 个，平均执行 %7 ms，吞吐 %8 个/小时，缓存命中 %9/%10")
+        .arg(m_jobs[run->jobIndex].name)
+        .arg(run->exitCode)
+        .arg(queueMs)
+        .arg(runMs)
+        .arg(finished)
+        .arg(m_metrics.failed)
+        .arg(finished > 0 ? m_metrics.totalRunMs / finished : 0)
+        .arg(uptimeHours > 0 ? finished / uptimeHours : 0.0, 0, 'f', 1)
+        .arg(cacheStats.hits)
+        .arg(cacheStats.requests);
+
+    writeMetrics(*run);
+    emit jobFinished(m_jobs[run->jobIndex].name, run->exitCode, queueMs + runMs);
+}
+
+// 每个任务一行 JSON，便于外部汇总
+void ReportScheduleService::writeMetrics(const JobRun& run)
+{
+    if (m_metricsFile.isEmpty()) return;
+
+    QFile file(m_metricsFile);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Append | QIODevice::Text)) {
+        qWarning() << "无法写入指标文件:" << m_metricsFile;
+        return;
+    }
+
+    const HistoryFetchCache::Stats cacheStats = m_cache.stats();
+
+    QJsonObject object;
+    object["time"] = QDateTime::currentDateTime().toString(Qt::ISODate);
+    object["job"] = m_jobs[run.jobIndex].name;
+    object["exitCode"] = run.exitCode;
+    object["queueMs"] = static_cast<double>(run.startedMs - run.queuedMs);
+    object["runMs"] = static_cast<double>(run.finishedMs - run.startedMs);
+    object["fetchMs"] = static_cast<double>(run.result.fetchMs);
+    object["alignMs"] = static_cast<double>(run.result.alignMs);
+    object["points"] = run.result.points;
+    object["columns"] = run.result.columns;
+    object["failedColumns"] = run.result.failedColumns.size();
+    object["output"] = run.result.outputFile;
+    object["cacheHits"] = static_cast<double>(cacheStats.hits);
+    object["cacheMisses"] = static_cast<double>(cacheStats.misses);
+    object["cacheWaits"] = static_cast<double>(cacheStats.waits);
+
+    file.write(QJsonDocument(object).toJson(QJsonDocument::Compact));
+    file.write("\n");
+}
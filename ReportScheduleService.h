@@ -0,0 +1,104 @@
+#pragma once
+#ifndef REPORTSCHEDULESERVICE_H
+#define REPORTSCHEDULESERVICE_H
+
+#include <QObject>
+#include <QTimer>
+#include <QThreadPool>
+#include <QElapsedTimer>
+#include <QDateTime>
+#include <QVector>
+#include <QSet>
+#include <memory>
+
+#include "BatchReportRunner.h"
+#include "HistoryFetchCache.h"
+
+// 定时报表服务（命令行 --service --schedule <文件>）
+// - 按计划表在固定时刻生成日报/周报/月报，到期任务进入队列
+// - 线程池限制同时运行的报表数，所有报表共用一个查询缓存
+// - 记录每个任务的排队/执行耗时和整体吞吐
+//
+// 计划表为 JSON：
+// {
+//   "maxConcurrent": 4, "outputDir": "...", "metricsFile": "...", "runOnStart": false,
+//   "jobs": [ { "config": "#REPO_xx.xlsx", "type": "daily", "at": "01:00", "interval": 300,
+//               "weekday": 1, "day": 1, "output": "..." } ]
+// }
+class ReportScheduleService : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct JobSpec {
+        QString name;
+        BatchReportOptions options;
+        QTime at;               // 每天的执行时刻
+        int weekday = 1;        // 周报：1=周一 … 7=周日
+        int dayOfMonth = 1;     // 月报：几号（超过当月天数取月末）
+        QDateTime nextRun;
+    };
+
+    struct Metrics {
+        qint64 submitted = 0;
+        qint64 completed = 0;
+        qint64 failed = 0;
+        qint64 totalQueueMs = 0;
+        qint64 totalRunMs = 0;
+        qint64 maxLatencyMs = 0;     // 排队 + 执行
+    };
+
+    explicit ReportScheduleService(QObject* parent = nullptr);
+    ~ReportScheduleService();
+
+    static bool isServiceInvocation(int argc, char* argv[]);
+
+    // 解析命令行、加载计划表并开始调度
+    bool start(const QStringList& arguments);
+
+    bool loadSchedule(const QString& filePath, QString& error);
+
+    // 立即把任务加入队列（已在队列或运行中的任务不重复加入）
+    bool enqueue(int jobIndex);
+
+    const QVector<JobSpec>& jobs() const { return m_jobs; }
+    const Metrics& metrics() const { return m_metrics; }
+    HistoryFetchCache& fetchCache() { return m_cache; }
+
+    // 下一次执行时间
+    static QDateTime nextRunAfter(const JobSpec& job, const QDateTime& now);
+
+signals:
+    void jobFinished(const QString& name, int exitCode, qint64 latencyMs);
+
+private slots:
+    void onTick();
+
+private:
+    struct JobRun {
+        int jobIndex;
+        qint64 queuedMs;
+        qint64 startedMs;
+        qint64 finishedMs;
+        int exitCode;
+        BatchReportResult result;
+    };
+
+    void onJobFinished(const std::shared_ptr<JobRun>& run);
+    void writeMetrics(const JobRun& run);
+
+private:
+    QVector<JobSpec> m_jobs;
+    QSet<int> m_activeJobs;
+
+    QTimer m_tickTimer;
+    QThreadPool m_pool;
+    HistoryFetchCache m_cache;
+    QElapsedTimer m_clock;
+
+    QString m_outputDir;
+    QString m_metricsFile;
+    Metrics m_metrics;
+};
+
+#endif // REPORTSCHEDULESERVICE_H
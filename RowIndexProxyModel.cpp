@@ -0,0 +1,165 @@
+#include "RowIndexProxyModel.h"
+
+// 单次 dataChanged 涉及的行数超过该值时整体刷新视图
+static const int kPerRowForwardLimit = 64;
+
+RowIndexProxyModel::RowIndexProxyModel(QObject* parent)
+    : QAbstractProxyModel(parent)
+{
+}
+
+void RowIndexProxyModel::setSourceModel(QAbstractItemModel* newSource)
+{
+    beginResetModel();
+
+    if (sourceModel()) {
+        disconnect(sourceModel(), nullptr, this, nullptr);
+    }
+
+    QAbstractProxyModel::setSourceModel(newSource);
+
+    if (newSource) {
+        connect(newSource, &QAbstractItemModel::dataChanged, this, &RowIndexProxyModel::onSourceDataChanged);
+        connect(newSource, &QAbstractItemModel::headerDataChanged, this, &RowIndexProxyModel::onSourceHeaderDataChanged);
+        connect(newSource, &QAbstractItemModel::modelReset, this, &RowIndexProxyModel::onSourceStructureChanged);
+        connect(newSource, &QAbstractItemModel::layoutChanged, this, &RowIndexProxyModel::onSourceStructureChanged);
+        connect(newSource, &QAbstractItemModel::rowsInserted, this, &RowIndexProxyModel::onSourceStructureChanged);
+        connect(newSource, &QAbstractItemModel::rowsRemoved, this, &RowIndexProxyModel::onSourceStructureChanged);
+        connect(newSource, &QAbstractItemModel::columnsInserted, this, &RowIndexProxyModel::onSourceStructureChanged);
+        connect(newSource, &QAbstractItemModel::columnsRemoved, this, &RowIndexProxyModel::onSourceStructureChanged);
+    }
+
+    m_rows.clear();
+    if (newSource) {
+        const int count = newSource->rowCount();
+        m_rows.reserve(count);
+        for (int i = 0; i < count; ++i) m_rows.append(i);
+    }
+    rebuildReverseMap();
+
+    endResetModel();
+}
+
+void RowIndexProxyModel::setRows(const QVector<int>& rows)
+{
+    beginResetModel();
+    m_rows = rows;
+    rebuildReverseMap();
+    endResetModel();
+}
+
+void RowIndexProxyModel::resetToAllRows()
+{
+    QVector<int> rows;
+    if (sourceModel()) {
+        const int count = sourceModel()->rowCount();
+        rows.reserve(count);
+        for (int i = 0; i < count; ++i) rows.append(i);
+    }
+    setRows(rows);
+}
+
+void RowIndexProxyModel::rebuildReverseMap()
+{
+    const int sourceRows = sourceModel() ? sourceModel()->rowCount() : 0;
+    m_proxyRowOf.fill(-1, sourceRows);
+
+    // 丢弃越界行号，保证映射始终有效
+    int out = 0;
+    for (int i = 0; i < m_rows.size(); ++i) {
+        int row = m_rows[i];
+        if (row < 0 || row >= sourceRows || m_proxyRowOf[row] >= 0) continue;
+        m_proxyRowOf[row] = out;
+        m_rows[out++] = row;
+    }
+    m_rows.resize(out);
+}
+
+int RowIndexProxyModel::proxyRowOf(int sourceRow) const
+{
+    return (sourceRow >= 0 && sourceRow < m_proxyRowOf.size()) ? m_proxyRowOf[sourceRow] : -1;
+}
+
+QModelIndex RowIndexProxyModel::mapToSource(const QModelIndex& proxyIndex) const
+{
+    if (!sourceModel() || !proxyIndex.isValid()) return QModelIndex();
+    if (proxyIndex.row() < 0 || proxyIndex.row() >= m_rows.size()) return QModelIndex();
+    return sourceModel()->index(m_rows[proxyIndex.row()], proxyIndex.column());
+}
+
+QModelIndex RowIndexProxyModel::mapFromSource(const QModelIndex& sourceIndex) const
+{
+    if (!sourceIndex.isValid()) return QModelIndex();
+    int row = proxyRowOf(sourceIndex.row());
+    return row >= 0 ? createIndex(row, sourceIndex.column()) : QModelIndex();
+}
+
+QModelIndex RowIndexProxyModel::index(int row, int column, const QModelIndex& parent) const
+{
+    if (parent.isValid() || row < 0 || row >= m_rows.size() || column < 0 || column >= columnCount()) {
+        return QModelIndex();
+    }
+    return createIndex(row, column);
+}
+
+QModelIndex RowIndexProxyModel::parent(const QModelIndex& child) const
+{
+    Q_UNUSED(child)
+    return QModelIndex();
+}
+
+int RowIndexProxyModel::rowCount(const QModelIndex& parent) const
+{
+    return parent.isValid() ? 0 : m_rows.size();
+}
+
+int RowIndexProxyModel::columnCount(const QModelIndex& parent) const
+{
+    return (parent.isValid() || !sourceModel()) ? 0 : sourceModel()->columnCount();
+}
+
+QVariant RowIndexProxyModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (!sourceModel()) return QVariant();
+
+    // 行表头显示源行号，便于对照原表
+    if (orientation == Qt::Vertical) {
+        if (section < 0 || section >= m_rows.size()) return QVariant();
+        return sourceModel()->headerData(m_rows[section], orientation, role);
+    }
+    return sourceModel()->headerData(section, orientation, role);
+}
+
+void RowIndexProxyModel::onSourceDataChanged(const QModelIndex& topLeft, const QModelIndex& bottomRight, const QVector<int>& roles)
+{
+    if (m_rows.isEmpty()) return;
+
+    const int first = topLeft.row();
+    const int last = bottomRight.row();
+    const int lastCol = columnCount() - 1;
+
+    if (last - first + 1 > kPerRowForwardLimit) {
+        emit dataChanged(index(0, topLeft.column()), index(m_rows.size() - 1, qMin(bottomRight.column(), lastCol)), roles);
+        return;
+    }
+
+    for (int row = first; row <= last; ++row) {
+        int proxyRow = proxyRowOf(row);
+        if (proxyRow < 0) continue;
+        emit dataChanged(index(proxyRow, topLeft.column()), index(proxyRow, qMin(bottomRight.column(), lastCol)), roles);
+    }
+}
+
+void RowIndexProxyModel::onSourceHeaderDataChanged(Qt::Orientation orientation, int first, int last)
+{
+    if (orientation == Qt::Horizontal) {
+        emit headerDataChanged(orientation, first, last);
+    } else if (!m_rows.isEmpty()) {
+        emit headerDataChanged(orientation, 0, m_rows.size() - 1);
+    }
+}
+
+void RowIndexProxyModel::onSourceStructureChanged()
+{
+    resetToAllRows();
+}
@@ -0,0 +1,50 @@
+#pragma once
+#ifndef ROWINDEXPROXYMODEL_H
+#define ROWINDEXPROXYMODEL_H
+
+#include <QAbstractProxyModel>
+#include <QVector>
+
+// 按行号列表映射的轻量代理模型
+// - 代理第 i 行对应源模型第 rows[i] 行，列一一对应
+// - 筛选/排序结果直接给出行号列表，不在 filterAcceptsRow 里逐行格式化比较
+// - 源模型结构变化（行列增删、重置）后行号失效，恢复为显示全部行
+class RowIndexProxyModel : public QAbstractProxyModel
+{
+    Q_OBJECT
+
+public:
+    explicit RowIndexProxyModel(QObject* parent = nullptr);
+
+    void setSourceModel(QAbstractItemModel* sourceModel) override;
+
+    // 设置显示的源行号（顺序即显示顺序）
+    void setRows(const QVector<int>& rows);
+    const QVector<int>& rows() const { return m_rows; }
+
+    // 源行号 → 代理行号，不在映射中返回 -1
+    int proxyRowOf(int sourceRow) const;
+
+    QModelIndex mapToSource(const QModelIndex& proxyIndex) const override;
+    QModelIndex mapFromSource(const QModelIndex& sourceIndex) const override;
+
+    QModelIndex index(int row, int column, const QModelIndex& parent = QModelIndex()) const override;
+    QModelIndex parent(const QModelIndex& child) const override;
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+
+private slots:
+    void onSourceDataChanged(const QModelIndex& topLeft, const QModelIndex& bottomRight, const QVector<int>& roles);
+    void onSourceHeaderDataChanged(Qt::Orientation orientation, int first, int last);
+    void onSourceStructureChanged();
+
+private:
+    void resetToAllRows();
+    void rebuildReverseMap();
+
+    QVector<int> m_rows;           // 代理行 → 源行
+    QVector<int> m_proxyRowOf;     // 源行 → 代理行（-1 表示被隐藏）
+};
+
+#endif // ROWINDEXPROXYMODEL_H
@@ -0,0 +1,23 @@
+#pragma once
+#ifndef RTDBBACKEND_H
+#define RTDBBACKEND_H
+
+#include "UniversalQueryEngine.h"
+#include "platform/rdbapi.h"
+
+// 实时库读取后端：UniversalQueryEngine 的分块查询最终落到这里
+// 默认是实际 RTDB（Rdb_QuickPolling 会话池），开发/压测时可换成进程内模拟
+class RtdbBackend
+{
+public:
+    virtual ~RtdbBackend() {}
+
+    virtual QString name() const = 0;
+
+    // 读取一块字段（可被多个线程并发调用）
+    // 成功时返回收到的响应数，并对每个响应的槽位写入 values[i]（未响应的槽位保持 Unknown）
+    // 返回 <=0 表示整块失败（与 RdbGetFieldValue 一致）
+    virtual int readFields(RDB_FIELD_STRU* fields, int count, RtdbValue* values) = 0;
+};
+
+#endif // RTDBBACKEND_H
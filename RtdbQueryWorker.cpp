@@ -0,0 +1,75 @@
+#include "RtdbQueryWorker.h"
+#include <QElapsedTimer>
+#include <QDateTime>
+#include <QDebug>
+
+BindingSampleSet::BindingSampleSet(const UniversalQueryEngine::BatchHandle& planBatch, int capacity)
+    : batch(planBatch)
+{
+    const QStringList keys = UniversalQueryEngine::batchKeys(planBatch);
+    rings.reserve(keys.size());
+    for (int i = 0; i < keys.size(); ++i) {
+        keyIndex.insert(keys[i], i);
+        rings.emplace_back(new SampleRingBuffer<TrendSample>(capacity));
+    }
+}
+
+void BindingSampleSet::produce(const UniversalQueryEngine::BatchHandle& resultBatch, const QVariantList& values, qint64 msecs)
+{
+    const QStringList keys = UniversalQueryEngine::batchKeys(resultBatch);
+    const bool samePlan = (resultBatch == batch);
+
+    for (int i = 0; i < keys.size() && i < values.size(); ++i) {
+        int ring = samePlan ? i : keyIndex.value(keys[i], -1);
+        if (ring < 0) continue;
+
+        bool ok = false;
+        double value = values[i].toDouble(&ok);
+        if (!ok || values[i].type() == QVariant::String) continue;
+
+        TrendSample sample;
+        sample.msecs = msecs;
+        sample.value = value;
+        rings[ring]->push(sample);
+    }
+}
+
+RtdbQueryWorker::RtdbQueryWorker(UniversalQueryEngine* engine, QObject* parent)
+    : QObject(parent)
+    , m_engine(engine)
+    , m_latestRequestId(0)
+{
+    qRegisterMetaType<UniversalQueryEngine::BatchHandle>("UniversalQueryEngine::BatchHandle");
+    qRegisterMetaType<BindingSampleSetPtr>("BindingSampleSetPtr");
+    qRegisterMetaType<UniversalQueryEngine::ChunkTimingList>("UniversalQueryEngine::ChunkTimingList");
+}
+
+void RtdbQueryWorker::supersede(quint64 requestId)
+{
+    quint64 current = m_latestRequestId.load();
+    while (requestId > current && !m_latestRequestId.compare_exchange_weak(current, requestId)) {
+    }
+}
+
+void RtdbQueryWorker::runQuery(quint64 requestId, const UniversalQueryEngine::BatchHandle& batch,
+    const BindingSampleSetPtr& samples)
+{
+    // 已有更新的请求在排队，本次结果必然被丢弃，不必再访问RTDB
+    if (requestId < m_latestRequestId.load()) {
+        qDebug() << "跳过过期的RTDB请求:" << requestId;
+        return;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+
+    UniversalQueryEngine::ChunkTimingList chunkTimings;
+    QVariantList values = m_engine->executeBatch(batch, &chunkTimings);
+
+    // 趋势样本在查询线程写入环形缓冲区，界面线程应用结果时取出
+    if (samples) {
+        samples->produce(batch, values, QDateTime::currentMSecsSinceEpoch());
+    }
+
+    emit queryFinished(requestId, batch, values, timer.elapsed(), chunkTimings);
+}
@@ -0,0 +1,56 @@
+#pragma once
+#ifndef RTDBQUERYWORKER_H
+#define RTDBQUERYWORKER_H
+
+#include <QObject>
+#include <QStringList>
+#include <QVariantList>
+#include <QHash>
+#include <atomic>
+#include <memory>
+#include "UniversalQueryEngine.h"
+#include "SampleRingBuffer.h"
+
+// 每个绑定键一个趋势环形缓冲区，随绑定计划创建；创建后 keyIndex 只读，可跨线程共享
+struct BindingSampleSet {
+    UniversalQueryEngine::BatchHandle batch;          // 对应绑定计划的批次
+    QHash<QString, int> keyIndex;                     // 绑定键 → rings 下标
+    std::vector<std::unique_ptr<SampleRingBuffer<TrendSample>>> rings;
+
+    BindingSampleSet(const UniversalQueryEngine::BatchHandle& planBatch, int capacity);
+
+    // 生产者侧：写入一次查询结果（非数值结果不记录）
+    void produce(const UniversalQueryEngine::BatchHandle& resultBatch, const QVariantList& values, qint64 msecs);
+};
+typedef std::shared_ptr<BindingSampleSet> BindingSampleSetPtr;
+Q_DECLARE_METATYPE(BindingSampleSetPtr)
+
+// RTDB 查询工作对象：运行在独立线程中，阻塞的 RdbGetFieldValue 不再占用界面线程
+// 请求按序号排队，新请求到达后尚未执行的旧请求直接丢弃
+class RtdbQueryWorker : public QObject
+{
+    Q_OBJECT
+
+public:
+    // engine 由调用方持有，生命周期需覆盖工作线程
+    explicit RtdbQueryWorker(UniversalQueryEngine* engine, QObject* parent = nullptr);
+
+    // 线程安全：标记最新请求序号，序号更小的排队请求将被跳过
+    void supersede(quint64 requestId);
+
+public slots:
+    // samples 为空时不记录趋势
+    void runQuery(quint64 requestId, const UniversalQueryEngine::BatchHandle& batch,
+        const BindingSampleSetPtr& samples);
+
+signals:
+    // values 与 batchKeys(batch) 下标一一对应，chunkTimings 为各分块的耗时
+    void queryFinished(quint64 requestId, const UniversalQueryEngine::BatchHandle& batch,
+        const QVariantList& values, qint64 elapsedMs, const UniversalQueryEngine::ChunkTimingList& chunkTimings);
+
+private:
+    UniversalQueryEngine* m_engine;
+    std::atomic<quint64> m_latestRequestId;
+};
+
+#endif // RTDBQUERYWORKER_H
@@ -0,0 +1,155 @@
+#include "RtdbSubscription.h"
+#include <QTimer>
+#include <QRandomGenerator>
+#include <QDebug>
+#include <cmath>
+
+RtdbSubscription::RtdbSubscription(QObject* parent)
+    : QObject(parent)
+{
+    qRegisterMetaType<UniversalQueryEngine::BatchHandle>("UniversalQueryEngine::BatchHandle");
+    qRegisterMetaType<QVector<int>>("QVector<int>");
+}
+
+RtdbSubscription::~RtdbSubscription()
+{
+}
+
+// ===== 轮询比对 =====
+
+PollingRtdbSubscription::PollingRtdbSubscription(UniversalQueryEngine* engine, int intervalMs, QObject* parent)
+    : RtdbSubscription(parent)
+    , m_engine(engine)
+    , m_intervalMs(qMax(100, intervalMs))
+    , m_timer(nullptr)
+{
+}
+
+void PollingRtdbSubscription::subscribe(const UniversalQueryEngine::BatchHandle& batch)
+{
+    // 定时器在所在线程中创建
+    if (!m_timer) {
+        m_timer = new QTimer(this);
+        connect(m_timer, &QTimer::timeout, this, &PollingRtdbSubscription::onPoll);
+    }
+
+    m_batch = batch;
+    m_lastValues.clear();
+
+    if (!m_batch) {
+        m_timer->stop();
+        return;
+    }
+
+    m_timer->start(m_intervalMs);
+    onPoll();
+}
+
+void PollingRtdbSubscription::unsubscribe()
+{
+    if (m_timer) {
+        m_timer->stop();
+    }
+    m_batch.reset();
+    m_lastValues.clear();
+}
+
+void PollingRtdbSubscription::onPoll()
+{
+    if (!m_batch) return;
+
+    QVariantList values = m_engine->executeBatch(m_batch);
+
+    QVector<int> indexes;
+    QVariantList changed;
+    const bool first = (m_lastValues.size() != values.size());
+    for (int i = 0; i < values.size(); ++i) {
+        if (first || m_lastValues[i] != values[i]) {
+            indexes.append(i);
+            changed.append(values[i]);
+        }
+    }
+    m_lastValues = values;
+
+    if (!indexes.isEmpty()) {
+        emit valuesChanged(m_batch, indexes, changed);
+    }
+}
+
+// ===== 模拟发布者 =====
+
+SimulatedRtdbPublisher::SimulatedRtdbPublisher(int intervalMs, QObject* parent)
+    : RtdbSubscription(parent)
+    , m_intervalMs(qMax(100, intervalMs))
+    , m_changeRatio(0.05)
+    , m_timer(nullptr)
+{
+}
+
+void SimulatedRtdbPublisher::setChangeRatio(double ratio)
+{
+    m_changeRatio = qBound(0.0, ratio, 1.0);
+}
+
+void SimulatedRtdbPublisher::subscribe(const UniversalQueryEngine::BatchHandle& batch)
+{
+    if (!m_timer) {
+        m_timer = new QTimer(this);
+        connect(m_timer, &QTimer::timeout, this, &SimulatedRtdbPublisher::onPublish);
+    }
+
+    m_batch = batch;
+    const int count = UniversalQueryEngine::batchKeys(batch).size();
+    if (count == 0) {
+        m_timer->stop();
+        m_values.clear();
+        return;
+    }
+
+    // 订阅时推送一次全部初值
+    QRandomGenerator* random = QRandomGenerator::global();
+    m_values.resize(count);
+    QVector<int> indexes(count);
+    QVariantList values;
+    values.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        m_values[i] = std::round(random->bounded(100.0) * 100.0) / 100.0;
+        indexes[i] = i;
+        values.append(m_values[i]);
+    }
+    emit valuesChanged(m_batch, indexes, values);
+
+    m_timer->start(m_intervalMs);
+}
+
+void SimulatedRtdbPublisher::unsubscribe()
+{
+    if (m_timer) {
+        m_timer->stop();
+    }
+    m_batch.reset();
+    m_values.clear();
+}
+
+void SimulatedRtdbPublisher::onPublish()
+{
+    const int count = m_values.size();
+    if (count == 0) return;
+
+    QRandomGenerator* random = QRandomGenerator::global();
+    const int changes = qMax(1, static_cast<int>(std::ceil(count * m_changeRatio)));
+
+    QVector<int> indexes;
+    QVariantList values;
+    indexes.reserve(changes);
+    values.reserve(changes);
+    for (int n = 0; n < changes; ++n) {
+        int i = random->bounded(count);
+        // 随机游走，保留两位小数
+        m_values[i] = std::round((m_values[i] + random->bounded(2.0) - 1.0) * 100.0) / 100.0;
+        indexes.append(i);
+        values.append(m_values[i]);
+    }
+
+    emit valuesChanged(m_batch, indexes, values);
+}
@@ -0,0 +1,81 @@
+#pragma once
+#ifndef RTDBSUBSCRIPTION_H
+#define RTDBSUBSCRIPTION_H
+
+#include <QObject>
+#include <QVector>
+#include <QVariantList>
+#include "UniversalQueryEngine.h"
+
+class QTimer;
+
+// RTDB 订阅：注册一次编译好的绑定批次，之后只推送变化的值
+// 对象应移动到查询线程中使用，subscribe/unsubscribe 通过队列调用
+class RtdbSubscription : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit RtdbSubscription(QObject* parent = nullptr);
+    virtual ~RtdbSubscription();
+
+public slots:
+    virtual void subscribe(const UniversalQueryEngine::BatchHandle& batch) = 0;
+    virtual void unsubscribe() = 0;
+
+signals:
+    // indexes 为 batchKeys(batch) 的下标，values 与 indexes 一一对应
+    void valuesChanged(const UniversalQueryEngine::BatchHandle& batch,
+        const QVector<int>& indexes, const QVariantList& values);
+};
+
+// 实际RTDB：平台接口没有变化推送，在查询线程内按周期读取并与上次结果比对，只推送变化项
+class PollingRtdbSubscription : public RtdbSubscription
+{
+    Q_OBJECT
+
+public:
+    PollingRtdbSubscription(UniversalQueryEngine* engine, int intervalMs, QObject* parent = nullptr);
+
+public slots:
+    void subscribe(const UniversalQueryEngine::BatchHandle& batch) override;
+    void unsubscribe() override;
+
+private slots:
+    void onPoll();
+
+private:
+    UniversalQueryEngine* m_engine;
+    int m_intervalMs;
+    QTimer* m_timer;
+    UniversalQueryEngine::BatchHandle m_batch;
+    QVariantList m_lastValues;
+};
+
+// 进程内模拟发布者：每个周期随机改变一部分绑定的值，用于无RTDB环境下调试订阅链路
+class SimulatedRtdbPublisher : public RtdbSubscription
+{
+    Q_OBJECT
+
+public:
+    explicit SimulatedRtdbPublisher(int intervalMs, QObject* parent = nullptr);
+
+    // 每个周期发生变化的绑定比例（0~1）
+    void setChangeRatio(double ratio);
+
+public slots:
+    void subscribe(const UniversalQueryEngine::BatchHandle& batch) override;
+    void unsubscribe() override;
+
+private slots:
+    void onPublish();
+
+private:
+    int m_intervalMs;
+    double m_changeRatio;
+    QTimer* m_timer;
+    UniversalQueryEngine::BatchHandle m_batch;
+    QVector<double> m_values;
+};
+
+#endif // RTDBSUBSCRIPTION_H
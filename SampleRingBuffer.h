@@ -0,0 +1,88 @@
+#pragma once
+#ifndef SAMPLERINGBUFFER_H
+#define SAMPLERINGBUFFER_H
+
+#include <QtGlobal>
+#include <atomic>
+#include <vector>
+
+// 实时趋势样本
+struct TrendSample {
+    qint64 msecs = 0;      // 采样时刻（毫秒时间戳）
+    double value = 0.0;
+};
+
+// 单生产者/单消费者无锁环形缓冲区
+// - 生产者（查询线程）只写 m_head，消费者（界面线程）只写 m_tail
+// - 容量向上取整为2的幂；满时丢弃新样本，不覆盖消费者尚未读取的数据
+template <typename T>
+class SampleRingBuffer
+{
+public:
+    explicit SampleRingBuffer(size_t capacity)
+        : m_head(0)
+        , m_tail(0)
+        , m_dropped(0)
+    {
+        size_t size = 2;
+        while (size < capacity) size <<= 1;
+        m_buffer.resize(size);
+        m_mask = size - 1;
+    }
+
+    SampleRingBuffer(const SampleRingBuffer&) = delete;
+    SampleRingBuffer& operator=(const SampleRingBuffer&) = delete;
+
+    size_t capacity() const { return m_buffer.size(); }
+
+    // 仅生产者线程调用
+    bool push(const T& item)
+    {
+        const size_t head = m_head.load(std::memory_order_relaxed);
+        const size_t tail = m_tail.load(std::memory_order_acquire);
+        if (head - tail >= m_buffer.size()) {
+            m_dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        m_buffer[head & m_mask] = item;
+        m_head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // 仅消费者线程调用
+    bool pop(T& item)
+    {
+        const size_t tail = m_tail.load(std::memory_order_relaxed);
+        const size_t head = m_head.load(std::memory_order_acquire);
+        if (tail == head) {
+            return false;
+        }
+        item = m_buffer[tail & m_mask];
+        m_tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // 仅消费者线程调用：取出全部样本追加到 out，返回数量
+    template <typename Container>
+    int drain(Container& out)
+    {
+        int count = 0;
+        T item;
+        while (pop(item)) {
+            out.append(item);
+            ++count;
+        }
+        return count;
+    }
+
+    quint64 droppedCount() const { return m_dropped.load(std::memory_order_relaxed); }
+
+private:
+    std::vector<T> m_buffer;
+    size_t m_mask;
+    std::atomic<size_t> m_head;
+    std::atomic<size_t> m_tail;
+    std::atomic<quint64> m_dropped;
+};
+
+#endif // SAMPLERINGBUFFER_H
@@ -7,7 +7,7 @@ include( $(DEVHOME)/source/include/projectdef.pro )
 LIBS += -liosal -ligdbi -lihmiapi -linetapi -lirtdbapi  -ltaos -litaosdbms
 INCLUDEPATH += $${APP_INC}
 
-QT += core widgets gui core-private gui-private svg
+QT += core widgets gui core-private gui-private svg concurrent
 
 SOURCES += \
     main.cpp\
@@ -19,6 +19,23 @@ SOURCES += \
 	UniversalQueryEngine.cpp\
 	TaosDataFetcher.cpp\
 	TimeSettingsDialog.cpp\
+	TimeSeriesKernels.cpp\
+	RealtimeRefreshScheduler.cpp\
+	RtdbQueryWorker.cpp\
+	RtdbSubscription.cpp\
+	CellTextIndex.cpp\
+	RowIndexProxyModel.cpp\
+	HistoryFilterEngine.cpp\
+	NumericFilterDialog.cpp\
+	HistorySortEngine.cpp\
+	HistoryReportPipeline.cpp\
+	BatchReportRunner.cpp\
+	HistoryFetchCache.cpp\
+	ReportScheduleService.cpp\
+	MultiReportGenerator.cpp\
+	MockBackends.cpp\
+	PipelineTrace.cpp\
+	ShardedHistoryFetcher.cpp\
 	
 
 HEADERS +=\
@@ -31,5 +48,31 @@ HEADERS +=\
 	UniversalQueryEngine.h\
 	TaosDataFetcher.h\
 	TimeSettingsDialog.h\
+	TimeSeriesKernels.h\
+	RealtimeRefreshScheduler.h\
+	RtdbQueryWorker.h\
+	RtdbSubscription.h\
+	SampleRingBuffer.h\
+	CellTextIndex.h\
+	RowIndexProxyModel.h\
+	HistoryFilterEngine.h\
+	NumericFilterDialog.h\
+	HistorySortEngine.h\
+	HistoryReportPipeline.h\
+	BatchReportRunner.h\
+	HistoryFetchCache.h\
+	ReportScheduleService.h\
+	MultiReportGenerator.h\
+	RtdbBackend.h\
+	HistoryBackend.h\
+	MockBackends.h\
+	PipelineTrace.h\
+	ShardedHistoryFetcher.h\
 
 RESOURCES += ReportTable.qrc
+
+# 性能基准（make benchmarks），在构建目录的 benchmarks 子目录中单独构建
+BENCHMARK_MKDIR = $(MKDIR) benchmarks
+win32: BENCHMARK_MKDIR = if not exist benchmarks mkdir benchmarks
+benchmarks.commands = $$BENCHMARK_MKDIR && cd benchmarks && $$QMAKE_QMAKE $$PWD/benchmarks/benchmarks.pro && $(MAKE)
+QMAKE_EXTRA_TARGETS += benchmarks
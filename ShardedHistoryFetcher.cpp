@@ -0,0 +1,195 @@
+#include "ShardedHistoryFetcher.h"
+#include "TaosDataFetcher.h"
+#include "HistoryFetchCache.h"
+#include "HistoryReportPipeline.h"
+#include "PipelineTrace.h"
+#include <QFuture>
+#include <QtConcurrent/QtConcurrentRun>
+#include <QDebug>
+#include <stdexcept>
+#include <limits>
+
+// 借出的查询对象在作用域结束时归还
+class ShardedHistoryFetcher::FetcherLease
+{
+public:
+    explicit FetcherLease(ShardedHistoryFetcher& owner)
+        : m_owner(owner)
+    {
+        QMutexLocker locker(&m_owner.m_fetcherMutex);
+        if (!m_owner.m_idleFetchers.empty()) {
+            m_fetcher = std::move(m_owner.m_idleFetchers.back());
+            m_owner.m_idleFetchers.pop_back();
+        }
+        locker.unlock();
+
+        if (!m_fetcher) {
+            m_fetcher.reset(new TaosDataFetcher());
+        }
+    }
+
+    ~FetcherLease()
+    {
+        QMutexLocker locker(&m_owner.m_fetcherMutex);
+        m_owner.m_idleFetchers.push_back(std::move(m_fetcher));
+    }
+
+    TaosDataFetcher& operator*() const { return *m_fetcher; }
+    TaosDataFetcher* operator->() const { return m_fetcher.get(); }
+
+private:
+    ShardedHistoryFetcher& m_owner;
+    std::unique_ptr<TaosDataFetcher> m_fetcher;
+};
+
+ShardedHistoryFetcher::ShardedHistoryFetcher(HistoryFetchCache* cache)
+    : m_cache(cache)
+    , m_shardSeconds(86400)
+{
+    bool ok = false;
+    const int hours = qEnvironmentVariable("SCADA_HISTORY_SHARD_HOURS").toInt(&ok);
+    if (ok) {
+        m_shardSeconds = hours * 3600;
+    }
+    m_shardPool.setMaxThreadCount(4);
+}
+
+ShardedHistoryFetcher::~ShardedHistoryFetcher()
+{
+    // 先等待在途的分片结束，再释放查询对象
+    m_shardPool.waitForDone();
+}
+
+void ShardedHistoryFetcher::setMaxParallelShards(int count)
+{
+    m_shardPool.setMaxThreadCount(qMax(1, count));
+}
+
+QVector<TimeRangeConfig> ShardedHistoryFetcher::planShards(const TimeRangeConfig& timeRange, int shardSeconds)
+{
+    QVector<TimeRangeConfig> shards;
+    if (!timeRange.isValid()) {
+        return shards;
+    }
+
+    const qint64 startSecs = timeRange.startTime.toSecsSinceEpoch();
+    const qint64 endSecs = timeRange.endTime.toSecsSinceEpoch();
+    if (shardSeconds <= 0 || endSecs - startSecs <= shardSeconds) {
+        shards.append(timeRange);
+        return shards;
+    }
+
+    const qint64 interval = timeRange.intervalSeconds;
+    const qint64 originSecs = QDateTime(timeRange.startTime.date(), QTime(0, 0, 0)).toSecsSinceEpoch();
+    qint64 boundary = originSecs + ((startSecs - originSecs) / shardSeconds + 1) * shardSeconds;
+    qint64 shardStart = startSecs;
+
+    while (shardStart <= endSecs) {
+        // 边界对齐到间隔的整数倍（与 TDengine INTERVAL 窗口一致），上一分片止于边界前一秒
+        const qint64 aligned = ((boundary + interval - 1) / interval) * interval;
+        boundary += shardSeconds;
+        if (aligned <= shardStart) {
+            continue;
+        }
+
+        const qint64 shardEnd = aligned >= endSecs ? endSecs : aligned - 1;
+        shards.append(TimeRangeConfig(QDateTime::fromSecsSinceEpoch(shardStart),
+            QDateTime::fromSecsSinceEpoch(shardEnd), timeRange.intervalSeconds));
+        shardStart = shardEnd + 1;
+    }
+    return shards;
+}
+
+ShardedHistoryFetcher::SeriesData ShardedHistoryFetcher::fetchShard(const QString& rtuId, const TimeRangeConfig& shard)
+{
+    FetcherLease fetcher(*this);
+    return m_cache
+        ? m_cache->fetch(*fetcher, rtuId, shard)
+        : fetcher->fetchDataFromAddress(HistoryReportPipeline::buildAddress(rtuId, shard).toStdString());
+}
+
+ShardedHistoryFetcher::SeriesData ShardedHistoryFetcher::fetch(const QString& rtuId, const TimeRangeConfig& timeRange,
+    QStringList* missingShards)
+{
+    const QVector<TimeRangeConfig> shards = planShards(timeRange, m_shardSeconds);
+    if (shards.size() <= 1) {
+        return fetchShard(rtuId, timeRange);
+    }
+
+    TRACE_SCOPE_ARG("history.shardedFetch", shards.size());
+
+    // 各分片并行查询，结果按分片顺序存放
+    QVector<SeriesData> parts(shards.size());
+    QVector<QString> errors(shards.size());
+    QVector<QFuture<void>> futures;
+    for (int i = 0; i < shards.size(); ++i) {
+        futures.append(QtConcurrent::run(&m_shardPool, [this, &rtuId, &shards, &parts, &errors, i]() {
+            TRACE_SCOPE_ARG("history.shard", i);
+            try {
+                parts[i] = fetchShard(rtuId, shards[i]);
+            }
+            catch (const std::exception& e) {
+                errors[i] = QString::fromUtf8(e.what());
+            }
+            catch (...) {
+                errors[i] = "未知异常";
+            }
+        }));
+    }
+    for (QFuture<void>& future : futures) {
+        future.waitForFinished();
+    }
+
+    // 缺少任一分片会使边界两侧的插值出错，整段按失败处理
+    for (int i = 0; i < shards.size(); ++i) {
+        if (!errors[i].isEmpty()) {
+            throw std::runtime_error(QString("分片 %1 ~ %2 查询失败: %3")
+                .arg(shards[i].startTime.toString("yyyy-MM-dd HH:mm:ss"))
+                .arg(shards[i].endTime.toString("yyyy-MM-dd HH:mm:ss"))
+                .arg(errors[i]).toStdString());
+        }
+    }
+
+    // 空分片：全部为空时按无数据返回；部分为空多半是该分片查询失败，重试一次
+    QVector<int> emptyShards;
+    for (int i = 0; i < shards.size(); ++i) {
+        if (parts[i].empty()) emptyShards.append(i);
+    }
+    if (emptyShards.size() == shards.size()) {
+        return SeriesData();
+    }
+    for (int i : emptyShards) {
+        try {
+            parts[i] = fetchShard(rtuId, shards[i]);
+        }
+        catch (...) {
+            // 重试失败与重试仍为空一样处理
+        }
+    }
+
+    // 分片时间不重叠且按顺序排列，依次追加到末尾
+    SeriesData merged;
+    for (int i = 0; i < shards.size(); ++i) {
+        SeriesData& part = parts[i];
+        if (part.empty()) {
+            // 缺失时段两端写入 NaN，对齐时落在该时段内的点均为空值
+            const QString span = QString("%1 ~ %2")
+                .arg(shards[i].startTime.toString("yyyy-MM-dd HH:mm:ss"))
+                .arg(shards[i].endTime.toString("yyyy-MM-dd HH:mm:ss"));
+            qWarning() << "分片无数据，按缺失处理:" << rtuId << span;
+            if (missingShards) missingShards->append(span);
+
+            const std::vector<float> missing(1, std::numeric_limits<float>::quiet_NaN());
+            merged.emplace_hint(merged.end(), shards[i].startTime.toSecsSinceEpoch(), missing);
+            merged.emplace_hint(merged.end(), shards[i].endTime.toSecsSinceEpoch(), missing);
+            continue;
+        }
+        for (auto& point : part) {
+            merged.emplace_hint(merged.end(), point.first, std::move(point.second));
+        }
+        SeriesData().swap(part);
+    }
+
+    qDebug() << "分片查询:" << rtuId << shards.size() << "个分片，" << merged.size() << "个点";
+    return merged;
+}
@@ -0,0 +1,67 @@
+#pragma once
+#ifndef SHARDEDHISTORYFETCHER_H
+#define SHARDEDHISTORYFETCHER_H
+
+#include <QString>
+#include <QVector>
+#include <QStringList>
+#include <QMutex>
+#include <QThreadPool>
+#include <map>
+#include <vector>
+#include <memory>
+#include <cstdint>
+
+#include "DataBindingConfig.h"
+
+class TaosDataFetcher;
+class HistoryFetchCache;
+
+// 长时间范围的分片查询（线程安全）
+// 月报/年报按天拆成多个分片，在独立的查询连接上并行执行，再按时间顺序拼成一条序列；
+// 分片边界对齐到采样间隔，查询窗口不会被截断，拼接后的序列跨边界插值与整段查询一致
+// 提供缓存时逐个分片经缓存查询，不同报表之间可复用相同日期的分片
+class ShardedHistoryFetcher
+{
+public:
+    typedef std::map<int64_t, std::vector<float>> SeriesData;
+
+    explicit ShardedHistoryFetcher(HistoryFetchCache* cache = nullptr);
+    ~ShardedHistoryFetcher();
+
+    // 分片长度（秒，默认一天）；<=0 时不分片。环境变量 SCADA_HISTORY_SHARD_HOURS 可覆盖默认值
+    void setShardSeconds(int seconds) { m_shardSeconds = seconds; }
+    int shardSeconds() const { return m_shardSeconds; }
+
+    // 同时执行的分片查询数（所有调用方共用，默认 4）
+    void setMaxParallelShards(int count);
+
+    // 查询 rtuId 在 timeRange 内的原始数据；任一分片失败时抛出异常
+    // 其他分片有数据而某个分片为空时（taosdbapi 连接失败也返回空结果）重试一次，
+    // 仍为空则在该分片时段两端写入 NaN，对齐时该时段为空值而不是跨过缺口插值；
+    // 这些分片的时段写入 missingShards（"起始 ~ 终止"）
+    SeriesData fetch(const QString& rtuId, const TimeRangeConfig& timeRange, QStringList* missingShards = nullptr);
+
+    // 拆分时间范围：第一个分片从起始时间开始、最后一个分片到终止时间结束，中间边界为分片长度的整数倍
+    // （按天分片即每日零点）并向上对齐到采样间隔；范围不超过一个分片长度时原样返回
+    static QVector<TimeRangeConfig> planShards(const TimeRangeConfig& timeRange, int shardSeconds);
+
+private:
+    ShardedHistoryFetcher(const ShardedHistoryFetcher&) = delete;
+    ShardedHistoryFetcher& operator=(const ShardedHistoryFetcher&) = delete;
+
+    // 单个分片：经缓存或直接在借出的查询对象上查询
+    SeriesData fetchShard(const QString& rtuId, const TimeRangeConfig& shard);
+
+    class FetcherLease;
+
+    HistoryFetchCache* m_cache;
+    int m_shardSeconds;
+
+    QMutex m_fetcherMutex;
+    std::vector<std::unique_ptr<TaosDataFetcher>> m_idleFetchers;   // 每个连接同一时间只给一个分片使用
+
+    QThreadPool m_shardPool;
+};
+
+#endif // SHARDEDHISTORYFETCHER_H
@@ -1,19 +1,54 @@
 #include "TaosDataFetcher.h"
+#include "MockBackends.h"
+#include "PipelineTrace.h"
+#include "taosdbapi.h"
+#include <QtGlobal>
 #include <sstream>
 #include <iomanip>
 #include <ctime>
 #include <iostream>
 #include <algorithm>
-#include <QMessageBox>
+
+namespace {
+
+    // TDengine 后端：直接转调 taosdbapi
+    class TaosHistoryBackend : public HistoryBackend
+    {
+    public:
+        const char* name() const override { return "taos"; }
+
+        std::map<int64_t, std::vector<float>> read(const std::vector<std::string>& ycnoList,
+            const std::string& startTime, const std::string& endTime, int interval) override
+        {
+            return m_api.read(ycnoList, startTime, endTime, interval);
+        }
+
+    private:
+        taosdbapi m_api;
+    };
+
+}
+
+std::unique_ptr<HistoryBackend> HistoryBackend::create()
+{
+    if (qEnvironmentVariable("SCADA_HISTORY_BACKEND").compare("mock", Qt::CaseInsensitive) == 0) {
+        return std::unique_ptr<HistoryBackend>(new MockHistoryBackend());
+    }
+    return std::unique_ptr<HistoryBackend>(new TaosHistoryBackend());
+}
 
 TaosDataFetcher::TaosDataFetcher()
-    : tdb(new taosdbapi())
+    : m_backend(HistoryBackend::create())
+{
+}
+
+TaosDataFetcher::TaosDataFetcher(std::unique_ptr<HistoryBackend> backend)
+    : m_backend(backend ? std::move(backend) : HistoryBackend::create())
 {
 }
 
 TaosDataFetcher::~TaosDataFetcher()
 {
-    delete tdb;
 }
 
 std::map<int64_t, std::vector<float>> TaosDataFetcher::fetchDataFromAddress(const std::string& address)
@@ -32,13 +67,13 @@ std::map<int64_t, std::vector<float>> TaosDataFetcher::fetchDataFromAddress(cons
     }
 
     try {
-        // 使用带时间间隔的查询
-        auto result = tdb->read(ycnoList, startTime, endTime, interval);
-        if (result.empty())
-        {
-            QMessageBox::warning(NULL, "警告", "未获取到有效数据，请检查taos连接", QMessageBox::Yes | QMessageBox::No, QMessageBox::Yes);
+        // 使用带时间间隔的查询（只读一次；无数据由调用方按列汇总提示，批处理下不能弹窗）
+        TRACE_SCOPE("taos.read");
+        auto result = m_backend->read(ycnoList, startTime, endTime, interval);
+        if (result.empty()) {
+            std::cerr << "未获取到有效数据，请检查taos连接: " << address << std::endl;
         }
-        return tdb->read(ycnoList, startTime, endTime, interval);
+        return result;
     }
     catch (const std::exception& e) {
         throw std::runtime_error(std::string("数据查询失败: ") + e.what());
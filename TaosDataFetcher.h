@@ -5,7 +5,8 @@
 #include <map>
 #include <vector>
 #include <string>
-#include "taosdbapi.h"
+#include <memory>
+#include "HistoryBackend.h"
 #include <QObject>
 #include <QString>
 
@@ -13,8 +14,12 @@ class TaosDataFetcher
 {
 public:
     TaosDataFetcher();
+    // 指定读取后端（模拟/压测用），为空时按环境变量创建
+    explicit TaosDataFetcher(std::unique_ptr<HistoryBackend> backend);
     ~TaosDataFetcher();
 
+    HistoryBackend* backend() const { return m_backend.get(); }
+
     // 从地址字符串获取数据
     std::map<int64_t, std::vector<float>> fetchDataFromAddress(const std::string& address);
 
@@ -35,8 +40,8 @@ private:
         std::string& endTime,
         int& interval);
 
-    // 数据库API对象
-    taosdbapi* tdb;
+    // 数据库读取后端
+    std::unique_ptr<HistoryBackend> m_backend;
 };
 
 #endif // TAOSDATAFETCHER_H
\ No newline at end of file
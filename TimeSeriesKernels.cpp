@@ -0,0 +1,116 @@
+#include "TimeSeriesKernels.h"
+#include <cmath>
+#include <limits>
+
+namespace TimeSeriesKernels {
+
+double integrate(const qint64* t, const double* v, int n, double* coveredSeconds)
+{
+    double area = 0.0;
+    double covered = 0.0;
+
+    for (int i = 1; i < n; ++i) {
+        double v0 = v[i - 1];
+        double v1 = v[i];
+        if (std::isnan(v0) || std::isnan(v1)) continue;
+
+        double dt = static_cast<double>(t[i] - t[i - 1]);
+        if (dt <= 0) continue;
+
+        area += (v0 + v1) * 0.5 * dt;
+        covered += dt;
+    }
+
+    if (coveredSeconds) *coveredSeconds = covered;
+    return area;
+}
+
+double timeWeightedAverage(const qint64* t, const double* v, int n)
+{
+    double covered = 0.0;
+    double area = integrate(t, v, n, &covered);
+
+    if (covered > 0) {
+        return area / covered;
+    }
+
+    // 只有单个有效点时直接返回该值
+    for (int i = 0; i < n; ++i) {
+        if (!std::isnan(v[i])) return v[i];
+    }
+    return std::numeric_limits<double>::quiet_NaN();
+}
+
+double counterDelta(const qint64* t, const double* v, int n, double* elapsedSeconds)
+{
+    double delta = 0.0;
+    int first = -1;
+    int last = -1;
+
+    for (int i = 0; i < n; ++i) {
+        double x = v[i];
+        if (std::isnan(x)) continue;
+
+        if (last >= 0) {
+            double d = x - v[last];
+            // 计数器复位：从0重新累计，本段增量即为当前值
+            delta += (d >= 0) ? d : x;
+        }
+        else {
+            first = i;
+        }
+        last = i;
+    }
+
+    if (first < 0 || first == last) {
+        if (elapsedSeconds) *elapsedSeconds = 0.0;
+        return std::numeric_limits<double>::quiet_NaN();
+    }
+
+    if (elapsedSeconds) {
+        *elapsedSeconds = t ? static_cast<double>(t[last] - t[first]) : 0.0;
+    }
+    return delta;
+}
+
+double durationAbove(const qint64* t, const double* v, int n, double threshold)
+{
+    double seconds = 0.0;
+
+    for (int i = 0; i + 1 < n; ++i) {
+        if (v[i] > threshold) {   // NaN 比较结果为 false，自动跳过
+            seconds += static_cast<double>(t[i + 1] - t[i]);
+        }
+    }
+    return seconds;
+}
+
+int countIf(const double* v, int n, CompareOp op, double operand)
+{
+    int count = 0;
+
+    // 比较方式在循环外分派，内层循环保持简单便于编译器向量化
+    switch (op) {
+    case CompareOp::Equal:
+        for (int i = 0; i < n; ++i) count += (v[i] == operand);
+        break;
+    case CompareOp::NotEqual:
+        for (int i = 0; i < n; ++i) count += (!std::isnan(v[i]) && v[i] != operand);
+        break;
+    case CompareOp::Greater:
+        for (int i = 0; i < n; ++i) count += (v[i] > operand);
+        break;
+    case CompareOp::GreaterEqual:
+        for (int i = 0; i < n; ++i) count += (v[i] >= operand);
+        break;
+    case CompareOp::Less:
+        for (int i = 0; i < n; ++i) count += (v[i] < operand);
+        break;
+    case CompareOp::LessEqual:
+        for (int i = 0; i < n; ++i) count += (v[i] <= operand);
+        break;
+    }
+    return count;
+}
+
+}
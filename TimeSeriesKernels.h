@@ -0,0 +1,36 @@
+#pragma once
+#ifndef TIMESERIESKERNELS_H
+#define TIMESERIESKERNELS_H
+
+#include <QtGlobal>
+
+// 时序统计内核：直接扫描对齐后的时间轴和数据列，每个函数单遍完成
+// t 为时间轴秒值，v 为对应数值，NaN 表示该点无数据
+namespace TimeSeriesKernels {
+
+    enum class CompareOp {
+        Equal,
+        NotEqual,
+        Greater,
+        GreaterEqual,
+        Less,
+        LessEqual
+    };
+
+    // 梯形积分（值×秒），跳过任一端为NaN的区间；coveredSeconds 返回参与积分的总时长
+    double integrate(const qint64* t, const double* v, int n, double* coveredSeconds = nullptr);
+
+    // 时间加权平均
+    double timeWeightedAverage(const qint64* t, const double* v, int n);
+
+    // 累计量差值（电度等计数器），数值回落视为计数器复位；elapsedSeconds 返回首末有效点的时间差
+    double counterDelta(const qint64* t, const double* v, int n, double* elapsedSeconds = nullptr);
+
+    // 超过阈值的累计时长（秒），按采样保持计算
+    double durationAbove(const qint64* t, const double* v, int n, double threshold);
+
+    // 满足条件的点数
+    int countIf(const double* v, int n, CompareOp op, double operand);
+}
+
+#endif // TIMESERIESKERNELS_H
@@ -303,29 +303,71 @@ void TimeSettingsDialog::updateEndTimeEditability()
 }
 
 void TimeSettingsDialog::calculateEndTime()
+{
+    // 自定义模式不自动计算，保持当前值
+    if (m_currentType == Custom) {
+        return;
+    }
+
+    m_endTime = endTimeFor(m_currentType, m_startTime);
+    m_endTimeEdit->setDateTime(m_endTime);
+}
+
+QDateTime TimeSettingsDialog::endTimeFor(ReportType type, const QDateTime& start)
 {
     QDateTime calculatedEnd;
 
-    switch (m_currentType) {
+    switch (type) {
     case Daily:
-        calculatedEnd = m_startTime.addDays(1);
+        calculatedEnd = start.addDays(1);
         break;
 
     case Weekly:
-        calculatedEnd = m_startTime.addDays(7);
+        calculatedEnd = start.addDays(7);
         break;
 
     case Monthly:
-        calculatedEnd = m_startTime.addDays(30);
+        calculatedEnd = start.addDays(30);
         break;
 
     case Custom:
-        // 自定义模式不自动计算，保持当前值
-        return;
+        return QDateTime();
     }
 
-    m_endTime = limitToCurrentTime(calculatedEnd);
-    m_endTimeEdit->setDateTime(m_endTime);
+    return limitToCurrentTime(calculatedEnd);
+}
+
+int TimeSettingsDialog::defaultIntervalSeconds(ReportType type)
+{
+    // 与 adjustIntervalForReportType 的界面默认值保持一致
+    switch (type) {
+    case Daily:   return 5 * 60;
+    case Weekly:  return 3600;
+    case Monthly: return 86400;
+    case Custom:  return 5 * 60;
+    }
+    return 5 * 60;
+}
+
+bool TimeSettingsDialog::parseReportType(const QString& text, ReportType& type)
+{
+    const QString key = text.trimmed().toLower();
+    if (key == "daily" || key == "日报") {
+        type = Daily;
+    }
+    else if (key == "weekly" || key == "周报") {
+        type = Weekly;
+    }
+    else if (key == "monthly" || key == "月报") {
+        type = Monthly;
+    }
+    else if (key == "custom" || key == "自定义") {
+        type = Custom;
+    }
+    else {
+        return false;
+    }
+    return true;
 }
 
 QDateTime TimeSettingsDialog::limitToCurrentTime(const QDateTime& time)
@@ -40,6 +40,14 @@ public:
     void setStartTime(const QDateTime& time);
     void setReportType(ReportType type);
 
+    // 无界面使用（批处理）：与对话框相同的时间规则
+    // 按报表类型由起始时间计算终止时间（不超过当前时间），自定义类型返回无效时间
+    static QDateTime endTimeFor(ReportType type, const QDateTime& start);
+    // 各报表类型的默认采样间隔（秒）
+    static int defaultIntervalSeconds(ReportType type);
+    // 解析 daily/weekly/monthly/custom 或 日报/周报/月报/自定义
+    static bool parseReportType(const QString& text, ReportType& type);
+
 private slots:
     void onReportTypeChanged(int id);
     void onStartTimeChanged(const QDateTime& dateTime);
@@ -52,7 +60,7 @@ private:
     void setupUI();
     void calculateEndTime();
     void updateIntervalDisplay();
-    QDateTime limitToCurrentTime(const QDateTime& time);
+    static QDateTime limitToCurrentTime(const QDateTime& time);
 
     void updateEndTimeEditability();  // 新增：更新终止时间是否可编辑
 	void adjustIntervalForReportType(); // 新增：根据报表类型调整间隔的合理范围和默认值
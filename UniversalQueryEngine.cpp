@@ -1,7 +1,18 @@
 #include "UniversalQueryEngine.h"
+#include "RtdbSubscription.h"
+#include "RtdbBackend.h"
+#include "MockBackends.h"
+#include "PipelineTrace.h"
 #include "platform/rdbapi.h"  // RTDBͷļ
 #include <QRegularExpression>
 #include <QDebug>
+#include <QSet>
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QFuture>
+#include <QtConcurrent/QtConcurrentRun>
+#include <cstring>
 #include <sstream>
 
 UniversalQueryEngine& UniversalQueryEngine::instance() {
@@ -9,107 +20,339 @@ UniversalQueryEngine& UniversalQueryEngine::instance() {
     return instance;
 }
 
-// --- µĹӿʵ ---
-QHash<QString, QVariant> UniversalQueryEngine::queryValuesForBindingKeys(QList<QString> bindingKeys)
+// RTDB Ựأ Rdb_QuickPollingÿβѯ½Ự
+struct UniversalQueryEngine::SessionPool
 {
-    QHash<QString, QVariant> finalResults;
-    if (bindingKeys.isEmpty()) {
-        return finalResults;
+    QMutex mutex;
+    std::vector<std::unique_ptr<Rdb_QuickPolling>> idle;
+    int maxIdle = 8;
+
+    std::unique_ptr<Rdb_QuickPolling> acquire()
+    {
+        QMutexLocker locker(&mutex);
+        if (idle.empty()) {
+            locker.unlock();
+            return std::unique_ptr<Rdb_QuickPolling>(new Rdb_QuickPolling());
+        }
+        std::unique_ptr<Rdb_QuickPolling> session = std::move(idle.back());
+        idle.pop_back();
+        return session;
+    }
+
+    void release(std::unique_ptr<Rdb_QuickPolling> session)
+    {
+        QMutexLocker locker(&mutex);
+        if (static_cast<int>(idle.size()) < maxIdle) {
+            idle.push_back(std::move(session));
+        }
+    }
+};
+
+// ĻỰʱ黹
+class UniversalQueryEngine::SessionLease
+{
+public:
+    explicit SessionLease(SessionPool& pool)
+        : m_pool(pool), m_session(pool.acquire()) {}
+    ~SessionLease() { m_pool.release(std::move(m_session)); }
+
+    Rdb_QuickPolling* operator->() const { return m_session.get(); }
+
+private:
+    SessionPool& m_pool;
+    std::unique_ptr<Rdb_QuickPolling> m_session;
+};
+
+// ʵRTDBˣڻỰؽ Rdb_QuickPolling ϲѯ
+class UniversalQueryEngine::LiveBackend : public RtdbBackend
+{
+public:
+    explicit LiveBackend(SessionPool& pool) : m_pool(pool) {}
+
+    QString name() const override { return "rtdb"; }
+
+    int readFields(RDB_FIELD_STRU* fields, int count, RtdbValue* values) override;
+
+private:
+    SessionPool& m_pool;
+};
+
+UniversalQueryEngine::UniversalQueryEngine()
+    : m_sessions(new SessionPool())
+    , m_chunkSize(500)
+{
+    m_chunkPool.setMaxThreadCount(4);
+
+    if (qEnvironmentVariable("SCADA_RTDB_BACKEND").compare("mock", Qt::CaseInsensitive) == 0) {
+        m_backend = std::make_shared<MockRtdbBackend>();
+        qDebug() << "UniversalQueryEngine: ʹģʵʱ";
     }
+    else {
+        m_backend = std::make_shared<LiveBackend>(*m_sessions);
+    }
+}
+
+UniversalQueryEngine::~UniversalQueryEngine()
+{
+    // ȵȴ;ķֿѯͷŻỰ
+    m_chunkPool.waitForDone();
+}
 
-    // 1. 룬б
-    std::vector<RtdbRequest> requests;
+void UniversalQueryEngine::setMaxIdleSessions(int count)
+{
+    QMutexLocker locker(&m_sessions->mutex);
+    m_sessions->maxIdle = qMax(0, count);
+    while (static_cast<int>(m_sessions->idle.size()) > m_sessions->maxIdle) {
+        m_sessions->idle.pop_back();
+    }
+}
+
+int UniversalQueryEngine::idleSessionCount() const
+{
+    QMutexLocker locker(&m_sessions->mutex);
+    return static_cast<int>(m_sessions->idle.size());
+}
+
+void UniversalQueryEngine::setBackend(std::shared_ptr<RtdbBackend> backend)
+{
+    if (!backend) {
+        backend = std::make_shared<LiveBackend>(*m_sessions);
+    }
+    std::atomic_store(&m_backend, std::move(backend));
+}
+
+std::shared_ptr<RtdbBackend> UniversalQueryEngine::backend() const
+{
+    return std::atomic_load(&m_backend);
+}
+
+void UniversalQueryEngine::setChunkSize(int requestsPerChunk)
+{
+    m_chunkSize.store(qMax(1, requestsPerChunk));
+}
+
+void UniversalQueryEngine::setMaxParallelChunks(int count)
+{
+    m_chunkPool.setMaxThreadCount(qMax(1, count));
+}
+
+// صĶûиɵ÷ƶѯ̲߳ͷ
+RtdbSubscription* UniversalQueryEngine::createSubscription(SubscriptionSource source, int intervalMs)
+{
+    if (source == SimulatedPublisher) {
+        return new SimulatedRtdbPublisher(intervalMs);
+    }
+    return new PollingRtdbSubscription(this, intervalMs);
+}
+
+// ԤΣkeys Ϊȥغȫfields ֻʽȷļ
+struct UniversalQueryEngine::CompiledBatch
+{
+    QStringList keys;
+    std::vector<RDB_FIELD_STRU> fields;
+    std::vector<int> keyOfField;      // fields ±  keys ±
+    std::vector<int> invalidKeys;     // ʽļkeys ±꣩
+};
+
+static void copyFieldName(char* dest, size_t size, const QString& text)
+{
+    // ʹC++11İȫ strcpy_sȷ㹻ʹ strcpy
+    strncpy(dest, text.toStdString().c_str(), size - 1);
+    // ȷַ null β
+    dest[size - 1] = '\0';
+}
+
+UniversalQueryEngine::BatchHandle UniversalQueryEngine::compileBatch(const QStringList& bindingKeys)
+{
+    std::shared_ptr<CompiledBatch> batch = std::make_shared<CompiledBatch>();
+
+    QSet<QString> seen;
     for (const QString& key : bindingKeys) {
-        if (!key.startsWith("##")) continue;
-
-        QString cleanKey = key.mid(2); // ȥ "##"
-        QStringList parts = cleanKey.split('/');
-
-        if (parts.size() >= 3) {
-            RtdbRequest req;
-            req.originalKey = key;
-            req.tableName = parts[0].toStdString();
-            req.objName = parts[1].toStdString();
-            req.fieldName = parts[2].toStdString();
-            requests.push_back(req);
+        if (seen.contains(key)) continue;
+        seen.insert(key);
+
+        int keyIndex = batch->keys.size();
+        batch->keys.append(key);
+
+        QStringList parts;
+        if (key.startsWith("##")) {
+            parts = key.mid(2).split('/'); // ȥ "##"
         }
-        else {
-            // ڸʽKeyֱڽб
-            finalResults[key] = "Invalid Format";
+
+        if (parts.size() < 3) {
+            batch->invalidKeys.push_back(keyIndex);
+            continue;
         }
+
+        RDB_FIELD_STRU field;
+        memset(&field, 0, sizeof(field));
+        copyFieldName(field.tabname, sizeof(field.tabname), parts[0]);
+        copyFieldName(field.objname, sizeof(field.objname), parts[1]);
+        copyFieldName(field.fldname, sizeof(field.fldname), parts[2]);
+        batch->fields.push_back(field);
+        batch->keyOfField.push_back(keyIndex);
     }
 
-    // 2. ִвѯ
-    if (!requests.empty()) {
-        executeRtdQuery(requests, finalResults);
+    return batch;
+}
+
+QStringList UniversalQueryEngine::batchKeys(const BatchHandle& batch)
+{
+    return batch ? batch->keys : QStringList();
+}
+
+// --- µĹӿʵ ---
+QHash<QString, QVariant> UniversalQueryEngine::queryValuesForBindingKeys(QList<QString> bindingKeys)
+{
+    QHash<QString, QVariant> finalResults;
+    if (bindingKeys.isEmpty()) {
+        return finalResults;
     }
 
-    // 3. õĽ
+    BatchHandle batch = compileBatch(bindingKeys);
+    QVariantList values = executeBatch(batch);
+    for (int i = 0; i < batch->keys.size(); ++i) {
+        finalResults[batch->keys[i]] = values[i];
+    }
     return finalResults;
 }
 
+QVariant RtdbValue::toVariant() const
+{
+    switch (type) {
+    case Integer: return QVariant(integer);
+    case Real:    return QVariant(real);
+    case Text:    return QVariant(text);
+    default:      return QVariant();
+    }
+}
 
-void UniversalQueryEngine::executeRtdQuery(
-    const std::vector<RtdbRequest>& requests,
-    QHash<QString, QVariant>& results // ֱ
-)
+int UniversalQueryEngine::LiveBackend::readFields(RDB_FIELD_STRU* fields, int count, RtdbValue* values)
 {
-    int N = requests.size();
-    if (N == 0) return;
+    SessionLease rsp(m_pool);
+    Rdb_MultiTypeValue rmtv;
+    int ret = rsp->RdbGetFieldValue(SYS_USER, "", count, fields, &rmtv);
+    if (ret <= 0) {
+        return ret;
+    }
+
+    for (int i = 0; i < ret; i++) {
+        int parano = rmtv.RdbGetValOrderno(i); // ȡӦӦĿ
 
-    // 1. ׼RTDBѯṹ
-    std::vector<RDB_FIELD_STRU> getfinfo(N);
-    for (int i = 0; i < N; ++i) {
-        // ʹC++11İȫ strcpy_sȷ㹻ʹ strcpy
-        strncpy(getfinfo[i].tabname, requests[i].tableName.c_str(), sizeof(getfinfo[i].tabname) - 1);
-        strncpy(getfinfo[i].objname, requests[i].objName.c_str(), sizeof(getfinfo[i].objname) - 1);
-        strncpy(getfinfo[i].fldname, requests[i].fieldName.c_str(), sizeof(getfinfo[i].fldname) - 1);
-        // ȷַ null β
-        getfinfo[i].tabname[sizeof(getfinfo[i].tabname) - 1] = '\0';
-        getfinfo[i].objname[sizeof(getfinfo[i].objname) - 1] = '\0';
-        getfinfo[i].fldname[sizeof(getfinfo[i].fldname) - 1] = '\0';
+        if (parano >= 0 && parano < count) {
+            // ʵȡɾȷʾģٽضС
+            values[parano] = RtdbValue::fromReal(rmtv.RdbGetVal_double(i));
+        }
     }
+    return ret;
+}
 
-    // 2. ִRTDBѯ
-    Rdb_QuickPolling rsp;
-    Rdb_MultiTypeValue rmtv;
-    int ret = rsp.RdbGetFieldValue(SYS_USER, "", N, getfinfo.data(), &rmtv);
+// ѯvalues ±Ϊ
+struct UniversalQueryEngine::ChunkResult
+{
+    ChunkTiming timing;
+    std::vector<RtdbValue> values;
+};
+
+// ڵǰִһ󣬿Ŵ0ʼ
+UniversalQueryEngine::ChunkResult UniversalQueryEngine::runChunk(const BatchHandle& batch, int offset, int count)
+{
+    TRACE_SCOPE_ARG("rtdb.chunk", count);
+    ChunkResult chunk;
+    chunk.timing.offset = offset;
+    chunk.timing.count = count;
+    chunk.values.resize(count);
 
-    // 3. ѯ
+    QElapsedTimer timer;
+    timer.start();
+
+    // RdbGetFieldValue β constһԤõ飨ٽַ
+    const RDB_FIELD_STRU* fields = batch->fields.data();
+    std::vector<RDB_FIELD_STRU> getfinfo(fields + offset, fields + offset + count);
+
+    // ִRTDBѯ
+    std::shared_ptr<RtdbBackend> backend = std::atomic_load(&m_backend);
+    int ret = backend->readFields(getfinfo.data(), count, chunk.values.data());
+    chunk.timing.ret = ret;
+
+    // ѯ
     if (ret <= 0) {
-        qDebug() << "RdbGetFieldValue API failed, ret =" << ret;
+        qDebug() << backend->name() << "readFields failed, ret =" << ret << "chunk offset =" << offset;
         // APIʧܣΪ
-        for (const auto& req : requests) {
-            results[req.originalKey] = "Query Error";
+        for (int i = 0; i < count; ++i) {
+            chunk.values[i] = RtdbValue::fromText("Query Error");
         }
-        return;
+        chunk.timing.elapsedMs = timer.elapsed();
+        return chunk;
     }
 
-    // һЩյӦ
-    std::vector<bool> responded(N, false);
+    for (int i = 0; i < count; ++i) {
+        if (chunk.values[i].type == RtdbValue::Unknown) {
+            // δյӦ
+            chunk.values[i] = RtdbValue::fromText("No Response");
+        }
+    }
 
-    for (int i = 0; i < ret; i++) {
-        int parano = rmtv.RdbGetValOrderno(i); // ȡӦӦԭʼ
+    chunk.timing.elapsedMs = timer.elapsed();
+    return chunk;
+}
 
-        if (parano >= 0 && parano < N) {
-            // ȡӦԭʼ
-            const RtdbRequest& originalRequest = requests[parano];
+QVariantList UniversalQueryEngine::executeBatch(const BatchHandle& batch, ChunkTimingList* timings)
+{
+    TRACE_SCOPE("rtdb.batch");
+    QVariantList results;
+    if (!batch) return results;
+
+    results.reserve(batch->keys.size());
+    for (int i = 0; i < batch->keys.size(); ++i) {
+        results.append(QVariant());
+    }
 
-            // RTDBлȡֵ (intԸҪʹ RdbGetVal_double, RdbGetVal_string )
-            int resultValue = rmtv.RdbGetVal_int(i);
+    // ڸʽKeyֱڽб
+    for (int keyIndex : batch->invalidKeys) {
+        results[keyIndex] = "Invalid Format";
+    }
 
-            // ʹԭʼKeyϣ
-            results[originalRequest.originalKey] = QVariant(resultValue);
+    int N = static_cast<int>(batch->fields.size());
+    if (N == 0) return results;
 
-            // ǴӦ
-            responded[parano] = true;
+    // 󣺵ʱֱڵǰִ߳
+    const int chunkSize = m_chunkSize.load();
+
+    std::vector<ChunkResult> chunks;
+    if (N <= chunkSize) {
+        chunks.push_back(runChunk(batch, 0, N));
+    }
+    else {
+        QVector<QFuture<ChunkResult>> futures;
+        for (int offset = 0; offset < N; offset += chunkSize) {
+            int count = qMin(chunkSize, N - offset);
+            futures.append(QtConcurrent::run(&m_chunkPool, [this, &batch, offset, count]() {
+                return runChunk(batch, offset, count);
+            }));
+        }
+        for (QFuture<ChunkResult>& future : futures) {
+            chunks.push_back(future.result());
         }
     }
 
-    // 4. δյӦ
-    for (int i = 0; i < N; ++i) {
-        if (!responded[i]) {
-            results[requests[i].originalKey] = "No Response";
+    // ϲ + ƫ = 
+    for (const ChunkResult& chunk : chunks) {
+        for (int i = 0; i < chunk.timing.count; ++i) {
+            results[batch->keyOfField[chunk.timing.offset + i]] = chunk.values[i].toVariant();
         }
+        if (timings) {
+            timings->append(chunk.timing);
+        }
+    }
+
+    if (chunks.size() > 1) {
+        qint64 slowest = 0;
+        for (const ChunkResult& chunk : chunks) {
+            slowest = qMax(slowest, chunk.timing.elapsedMs);
+        }
+        qDebug() << "RTDBֿѯ" << N << "" << chunks.size() << "飬ʱ" << slowest << "ms";
     }
-}
\ No newline at end of file
+
+    return results;
+}
@@ -6,12 +6,46 @@
 #include <map>
 #include <vector>
 #include <string>
+#include <memory>
+#include <atomic>
 #include <QVariant>
+#include <QVector>
+#include <QThreadPool>
 #include <QHash>
+#include <QStringList>
+#include <QMetaType>
+
+class RtdbSubscription;
+class RtdbBackend;
+
+// RTDB ȡͻλֱֶӱ棬ֻڽģʱתһ QVariant
+struct RtdbValue {
+    enum Type : quint8 { Unknown, Integer, Real, Text };
+
+    Type type = Unknown;
+    qint64 integer = 0;
+    double real = 0.0;
+    QString text;
+
+    static RtdbValue fromInteger(qint64 v) { RtdbValue r; r.type = Integer; r.integer = v; return r; }
+    static RtdbValue fromReal(double v) { RtdbValue r; r.type = Real; r.real = v; return r; }
+    static RtdbValue fromText(const QString& v) { RtdbValue r; r.type = Text; r.text = v; return r; }
+
+    QVariant toVariant() const;
+};
 
 // ͨòѯ
+// ɰ/̸߳ʵÿʵжRTDBỰأйз̰߳ȫ
+// instance() Ϊ̼Ĭʵݾɵ÷
 class  UniversalQueryEngine {
 public:
+    UniversalQueryEngine();
+    ~UniversalQueryEngine();
+
+    // ԤĲѯΣȥغļ + õ RDB_FIELD_STRU 飩ݶⲻɼ
+    struct CompiledBatch;
+    typedef std::shared_ptr<const CompiledBatch> BatchHandle;
+
     static UniversalQueryEngine& instance();
 
     // ִRTDBѯ
@@ -19,27 +53,63 @@ public:
         QList<QString> bindingKeys
     );
 
+    // ΣظļֻһʽļRTDB
+    static BatchHandle compileBatch(const QStringList& bindingKeys);
+    static QStringList batchKeys(const BatchHandle& batch);
+
+    // ֿѯĺʱͳ
+    struct ChunkTiming {
+        int offset = 0;          // ڵһе
+        int count = 0;
+        int ret = 0;             // RdbGetFieldValue ֵ
+        qint64 elapsedMs = 0;
+    };
+    typedef QVector<ChunkTiming> ChunkTimingList;
+
+    // ִԤΣֵ batchKeys ±һһӦ̲߳ã
+    // 󳬹Сʱֳɶ飬ڶ Rdb_QuickPolling ϲִ
+    QVariantList executeBatch(const BatchHandle& batch, ChunkTimingList* timings = nullptr);
+
+    // ģעκֻͱ仯ֵ
+    enum SubscriptionSource {
+        RtdbPolling,          // ʵRTDBѯ߳ѯȶԣ
+        SimulatedPublisher    // ģ
+    };
+    RtdbSubscription* createSubscription(SubscriptionSource source, int intervalMs);
+
+    // ֿ̰߳ȫ
+    void setChunkSize(int requestsPerChunk);
+    int chunkSize() const { return m_chunkSize.load(); }
+    void setMaxParallelChunks(int count);
+    int maxParallelChunks() const { return m_chunkPool.maxThreadCount(); }
+
+    // Ựأе Rdb_QuickPolling Ựౣĸ
+    void setMaxIdleSessions(int count);
+    int idleSessionCount() const;
+
+    // ȡˣĬΪʵRTDB SCADA_RTDB_BACKEND=mock ʱΪģ
+    // 滻ѿʼķֿѯʹԭ
+    void setBackend(std::shared_ptr<RtdbBackend> backend);
+    std::shared_ptr<RtdbBackend> backend() const;
+
 private:
-    UniversalQueryEngine() = default;
-    ~UniversalQueryEngine() = default;
     UniversalQueryEngine(const UniversalQueryEngine&) = delete;
     UniversalQueryEngine& operator=(const UniversalQueryEngine&) = delete;
 
-    struct RtdbRequest
-    {
-        QString originalKey;
-        std::string tableName;
-        std::string objName;
-        std::string fieldName;
-    };
+    struct ChunkResult;
+    ChunkResult runChunk(const BatchHandle& batch, int offset, int count);
 
+    struct SessionPool;
+    class SessionLease;
+    class LiveBackend;
+    std::unique_ptr<SessionPool> m_sessions;
+    std::shared_ptr<RtdbBackend> m_backend;   // ͨ std::atomic_load/atomic_store 
 
-    // ַ
-    void executeRtdQuery(
-        const std::vector<RtdbRequest>& requests,
-        QHash<QString, QVariant>& results
-    );
-
+    std::atomic<int> m_chunkSize;
+    QThreadPool m_chunkPool;     // ֿѯרãռȫ̳߳
 };
 
+Q_DECLARE_METATYPE(UniversalQueryEngine::BatchHandle)
+Q_DECLARE_METATYPE(UniversalQueryEngine::ChunkTimingList)
+
 #endif // UNIVERSALQUERYENGINE_H
\ No newline at end of file
@@ -0,0 +1,91 @@
+#include "BenchmarkRunner.h"
+#include <QElapsedTimer>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QDateTime>
+#include <QSysInfo>
+#include <QFile>
+#include <QTextStream>
+#include <algorithm>
+
+BenchmarkRunner::BenchmarkRunner(int iterations, const QString& filter)
+    : m_iterations(qMax(1, iterations))
+    , m_filter(filter)
+{
+}
+
+void BenchmarkRunner::run(const QString& name, qint64 items, const std::function<void()>& body)
+{
+    if (!m_filter.isEmpty() && !name.contains(m_filter, Qt::CaseInsensitive)) {
+        return;
+    }
+
+    body();     // 预热
+
+    QVector<double> samples;
+    samples.reserve(m_iterations);
+    QElapsedTimer timer;
+    for (int i = 0; i < m_iterations; ++i) {
+        timer.start();
+        body();
+        samples.append(timer.nsecsElapsed() / 1e6);
+    }
+    std::sort(samples.begin(), samples.end());
+
+    Result result;
+    result.name = name;
+    result.iterations = m_iterations;
+    result.items = items;
+    result.minMs = samples.first();
+    result.maxMs = samples.last();
+    result.medianMs = samples[samples.size() / 2];
+    double total = 0.0;
+    for (double ms : samples) total += ms;
+    result.meanMs = total / samples.size();
+    m_results.append(result);
+
+    QTextStream out(stdout);
+    out << QString("%1  中位 %2 ms  最小 %3 ms  %4 项/秒")
+        .arg(name, -28)
+        .arg(result.medianMs, 10, 'f', 3)
+        .arg(result.minMs, 10, 'f', 3)
+        .arg(result.medianMs > 0 ? items / (result.medianMs / 1000.0) : 0.0, 0, 'f', 0)
+        << Qt::endl;
+}
+
+QJsonObject BenchmarkRunner::toJson(const QJsonObject& parameters) const
+{
+    QJsonArray cases;
+    for (const Result& result : m_results) {
+        QJsonObject object;
+        object["name"] = result.name;
+        object["iterations"] = result.iterations;
+        object["items"] = static_cast<double>(result.items);
+        object["minMs"] = result.minMs;
+        object["medianMs"] = result.medianMs;
+        object["meanMs"] = result.meanMs;
+        object["maxMs"] = result.maxMs;
+        object["itemsPerSecond"] = result.medianMs > 0 ? result.items / (result.medianMs / 1000.0) : 0.0;
+        cases.append(object);
+    }
+
+    QJsonObject root;
+    root["timestamp"] = QDateTime::currentDateTime().toString(Qt::ISODate);
+    root["host"] = QSysInfo::machineHostName();
+    root["cpu"] = QSysInfo::currentCpuArchitecture();
+    root["os"] = QSysInfo::prettyProductName();
+    root["qt"] = QString(qVersion());
+    root["parameters"] = parameters;
+    root["results"] = cases;
+    return root;
+}
+
+bool BenchmarkRunner::writeJson(const QString& filePath, const QJsonObject& parameters) const
+{
+    QFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        return false;
+    }
+    file.write(QJsonDocument(toJson(parameters)).toJson(QJsonDocument::Indented));
+    return true;
+}
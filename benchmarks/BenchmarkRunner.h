@@ -0,0 +1,41 @@
+#pragma once
+#ifndef BENCHMARKRUNNER_H
+#define BENCHMARKRUNNER_H
+
+#include <QString>
+#include <QVector>
+#include <QJsonObject>
+#include <functional>
+
+// 极简基准框架：每个用例先预热一次，再重复执行统计耗时，结果输出为 JSON
+class BenchmarkRunner
+{
+public:
+    struct Result {
+        QString name;
+        int iterations = 0;
+        qint64 items = 0;           // 每次迭代处理的条目数（点/单元格）
+        double minMs = 0.0;
+        double medianMs = 0.0;
+        double meanMs = 0.0;
+        double maxMs = 0.0;
+    };
+
+    explicit BenchmarkRunner(int iterations, const QString& filter = QString());
+
+    // body 执行一次被测操作；items 用于计算吞吐
+    void run(const QString& name, qint64 items, const std::function<void()>& body);
+
+    const QVector<Result>& results() const { return m_results; }
+
+    // parameters 记录合成数据参数，便于不同机器/版本对比
+    QJsonObject toJson(const QJsonObject& parameters) const;
+    bool writeJson(const QString& filePath, const QJsonObject& parameters) const;
+
+private:
+    int m_iterations;
+    QString m_filter;
+    QVector<Result> m_results;
+};
+
+#endif // BENCHMARKRUNNER_H
@@ -0,0 +1,104 @@
+#include "SyntheticData.h"
+#include <QRandomGenerator>
+#include <cmath>
+
+static const double kTwoPi = 6.283185307179586;
+
+SyntheticData::SyntheticData(const SyntheticDataOptions& options)
+    : m_options(options)
+    , m_start(QDate(2024, 1, 1), QTime(0, 0, 0))
+{
+    QRandomGenerator random(m_options.seed);
+    const qint64 startSecs = m_start.toSecsSinceEpoch();
+    const qint64 endSecs = startSecs + static_cast<qint64>(m_options.days) * 86400;
+    const QStringList ids = tagIds();
+
+    for (int t = 0; t < ids.size(); ++t) {
+        RawRows rows;
+        rows.timestamps.reserve(static_cast<int>((endSecs - startSecs) / m_options.intervalSeconds + 1));
+        rows.values.reserve(rows.timestamps.capacity());
+
+        // 每个测点一条带噪声的正弦曲线
+        const double base = 50.0 + t * 3.0;
+        const double amplitude = 10.0 + (t % 7);
+        int gapRemaining = 0;
+
+        for (qint64 ts = startSecs; ts <= endSecs; ts += m_options.intervalSeconds) {
+            if (gapRemaining > 0) {
+                --gapRemaining;
+                continue;
+            }
+            if (random.generateDouble() < m_options.gapRatio) {
+                gapRemaining = m_options.gapLength;
+                continue;
+            }
+
+            qint64 jitter = m_options.jitterSeconds > 0
+                ? random.bounded(-m_options.jitterSeconds, m_options.jitterSeconds + 1)
+                : 0;
+            double phase = (ts - startSecs) / 86400.0 * kTwoPi;
+            double value = base + amplitude * std::sin(phase + t) + (random.generateDouble() - 0.5);
+
+            rows.timestamps.append(ts + jitter);
+            rows.values.append(static_cast<float>(value));
+        }
+        m_rawRows.insert(ids[t], rows);
+    }
+}
+
+QStringList SyntheticData::tagIds() const
+{
+    QStringList ids;
+    for (int i = 0; i < m_options.tags; ++i) {
+        ids.append(QString("AIRTU%1").arg(i + 1, 9, 10, QChar('0')));
+    }
+    return ids;
+}
+
+TimeRangeConfig SyntheticData::timeRange() const
+{
+    return TimeRangeConfig(m_start, m_start.addDays(m_options.days), m_options.intervalSeconds);
+}
+
+HistoryReportConfig SyntheticData::reportConfig() const
+{
+    HistoryReportConfig config;
+    config.reportName = "benchmark";
+    const QStringList ids = tagIds();
+    for (int i = 0; i < ids.size(); ++i) {
+        ReportColumnConfig col;
+        col.displayName = QString("测点%1").arg(i + 1);
+        col.rtuId = ids[i];
+        col.sourceRow = i + 1;
+        config.columns.append(col);
+    }
+    return config;
+}
+
+SyntheticData::Series SyntheticData::decode(const RawRows& rows)
+{
+    // 与 taosdbapi 返回格式一致：时间戳升序，每个时刻一组值
+    Series series;
+    for (int i = 0; i < rows.timestamps.size(); ++i) {
+        series.emplace_hint(series.end(), rows.timestamps[i], std::vector<float>(1, rows.values[i]));
+    }
+    return series;
+}
+
+QHash<QString, SyntheticData::Series> SyntheticData::series() const
+{
+    QHash<QString, Series> result;
+    for (auto it = m_rawRows.constBegin(); it != m_rawRows.constEnd(); ++it) {
+        result.insert(it.key(), decode(it.value()));
+    }
+    return result;
+}
+
+qint64 SyntheticData::totalSamples() const
+{
+    qint64 total = 0;
+    for (const RawRows& rows : m_rawRows) {
+        total += rows.timestamps.size();
+    }
+    return total;
+}
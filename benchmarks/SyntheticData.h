@@ -0,0 +1,57 @@
+#pragma once
+#ifndef SYNTHETICDATA_H
+#define SYNTHETICDATA_H
+
+#include <QHash>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QDateTime>
+#include <map>
+#include <vector>
+#include <cstdint>
+
+#include "DataBindingConfig.h"
+
+// 合成历史数据：模拟 taosdbapi::read 返回的 (秒级时间戳 → 值) 序列
+struct SyntheticDataOptions {
+    int tags = 20;                  // 测点数
+    int days = 1;                   // 时间跨度（天）
+    int intervalSeconds = 60;       // 名义采样间隔
+    int jitterSeconds = 5;          // 采样时刻随机抖动（±秒）
+    double gapRatio = 0.01;         // 缺数概率（每个采样点）
+    int gapLength = 30;             // 发生缺数时连续缺失的点数
+    quint32 seed = 20240101;
+};
+
+class SyntheticData
+{
+public:
+    typedef std::map<int64_t, std::vector<float>> Series;
+
+    explicit SyntheticData(const SyntheticDataOptions& options);
+
+    const SyntheticDataOptions& options() const { return m_options; }
+    QStringList tagIds() const;
+    TimeRangeConfig timeRange() const;
+    HistoryReportConfig reportConfig() const;
+
+    // 扁平的原始行（模拟数据库结果集），decode 基准从这里构造 Series
+    struct RawRows {
+        QVector<qint64> timestamps;
+        QVector<float> values;
+    };
+    const RawRows& rawRows(const QString& tagId) const { return m_rawRows[tagId]; }
+
+    static Series decode(const RawRows& rows);
+
+    QHash<QString, Series> series() const;
+    qint64 totalSamples() const;
+
+private:
+    SyntheticDataOptions m_options;
+    QDateTime m_start;
+    QHash<QString, RawRows> m_rawRows;
+};
+
+#endif // SYNTHETICDATA_H
@@ -0,0 +1,44 @@
+TEMPLATE = app
+LANGUAGE = C++
+TARGET = ScadaReportBenchmarks
+CONFIG += console
+CONFIG -= app_bundle
+
+# 与主程序使用相同的依赖（数据库接口库需可链接，基准本身不访问数据库）
+include(../QXlsx/QXlsx/QXlsx.pri)
+include( $(DEVHOME)/source/include/projectdef.pro )
+LIBS += -liosal -ligdbi -lihmiapi -linetapi -lirtdbapi  -ltaos -litaosdbms
+INCLUDEPATH += $${APP_INC} ..
+
+QT += core widgets gui core-private gui-private svg concurrent
+
+SOURCES += \
+    main.cpp\
+	SyntheticData.cpp\
+	BenchmarkRunner.cpp\
+	../reportdatamodel.cpp\
+	../formulaengine.cpp\
+	../excelhandler.cpp\
+	../UniversalQueryEngine.cpp\
+	../TimeSeriesKernels.cpp\
+	../RtdbQueryWorker.cpp\
+	../RtdbSubscription.cpp\
+	../MockBackends.cpp\
+	../PipelineTrace.cpp\
+
+HEADERS +=\
+	SyntheticData.h\
+	BenchmarkRunner.h\
+	../reportdatamodel.h\
+	../formulaengine.h\
+	../excelhandler.h\
+	../DataBindingConfig.h\
+	../UniversalQueryEngine.h\
+	../TimeSeriesKernels.h\
+	../RtdbQueryWorker.h\
+	../RtdbSubscription.h\
+	../SampleRingBuffer.h\
+	../RtdbBackend.h\
+	../HistoryBackend.h\
+	../MockBackends.h\
+	../PipelineTrace.h\
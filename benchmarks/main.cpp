@@ -0,0 +1,165 @@
+#include <QApplication>
+#include <QCommandLineParser>
+#include <QCommandLineOption>
+#include <QTemporaryDir>
+#include <QJsonObject>
+#include <QTextStream>
+
+#include "SyntheticData.h"
+#include "BenchmarkRunner.h"
+#include "reportdatamodel.h"
+#include "formulaengine.h"
+
+// 基准运行时默认屏蔽业务代码的 qDebug 输出
+static bool g_verbose = false;
+
+static void benchmarkMessageHandler(QtMsgType type, const QMessageLogContext& context, const QString& message)
+{
+    Q_UNUSED(context)
+    if (type == QtDebugMsg && !g_verbose) return;
+    QTextStream(stderr) << message << Qt::endl;
+}
+
+int main(int argc, char* argv[])
+{
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+    QApplication app(argc, argv);
+    qInstallMessageHandler(benchmarkMessageHandler);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("SCADA报表控件性能基准");
+    parser.addHelpOption();
+
+    QCommandLineOption tagsOption("tags", "测点数", "n", "20");
+    QCommandLineOption daysOption("days", "时间跨度（天）", "n", "1");
+    QCommandLineOption intervalOption("interval", "采样间隔（秒）", "s", "60");
+    QCommandLineOption jitterOption("jitter", "采样时刻抖动（±秒）", "s", "5");
+    QCommandLineOption gapOption("gap", "缺数概率（0~1）", "ratio", "0.01");
+    QCommandLineOption cellsOption("cells", "Excel 读写用例的行数（20列）", "n", "500");
+    QCommandLineOption iterationsOption("iterations", "每个用例重复次数", "n", "5");
+    QCommandLineOption filterOption("filter", "只运行名称包含该字符串的用例", "text");
+    QCommandLineOption outputOption("output", "JSON 结果文件", "file", "benchmark_results.json");
+    QCommandLineOption verboseOption("verbose", "显示业务代码日志");
+
+    parser.addOptions({ tagsOption, daysOption, intervalOption, jitterOption, gapOption, cellsOption,
+        iterationsOption, filterOption, outputOption, verboseOption });
+    parser.process(app);
+
+    g_verbose = parser.isSet(verboseOption);
+
+    SyntheticDataOptions options;
+    options.tags = qMax(1, parser.value(tagsOption).toInt());
+    options.days = qMax(1, parser.value(daysOption).toInt());
+    options.intervalSeconds = qMax(1, parser.value(intervalOption).toInt());
+    options.jitterSeconds = qMax(0, parser.value(jitterOption).toInt());
+    options.gapRatio = qBound(0.0, parser.value(gapOption).toDouble(), 1.0);
+    const int excelRows = qMax(1, parser.value(cellsOption).toInt());
+    const int excelCols = 20;
+
+    QTextStream(stdout) << QString("合成数据：%1 个测点 × %2 天，间隔 %3 秒，抖动 ±%4 秒，缺数概率 %5")
+        .arg(options.tags).arg(options.days).arg(options.intervalSeconds)
+        .arg(options.jitterSeconds).arg(options.gapRatio) << Qt::endl;
+
+    SyntheticData data(options);
+    const TimeRangeConfig range = data.timeRange();
+    const QVector<QDateTime> timeAxis = ReportDataModel::generateTimeAxis(range);
+    const QHash<QString, SyntheticData::Series> series = data.series();
+    const qint64 points = timeAxis.size();
+
+    BenchmarkRunner runner(parser.value(iterationsOption).toInt(), parser.value(filterOption));
+
+    // ===== 时间轴 =====
+    runner.run("timeaxis.generate", points, [&]() {
+        QVector<QDateTime> axis = ReportDataModel::generateTimeAxis(range);
+        Q_UNUSED(axis)
+    });
+
+    // ===== 查询结果解码（数据库行 → 时间戳映射） =====
+    const QStringList tags = data.tagIds();
+    runner.run("fetch.decode", data.totalSamples(), [&]() {
+        for (const QString& tag : tags) {
+            SyntheticData::Series decoded = SyntheticData::decode(data.rawRows(tag));
+            Q_UNUSED(decoded)
+        }
+    });
+
+    // ===== 时间对齐 =====
+    runner.run("align.interpolation", points * options.tags, [&]() {
+        QHash<QString, QVector<double>> aligned = ReportDataModel::alignDataWithInterpolation(series, timeAxis);
+        Q_UNUSED(aligned)
+    });
+
+    // ===== 历史报表模型 =====
+    const QHash<QString, QVector<double>> aligned = ReportDataModel::alignDataWithInterpolation(series, timeAxis);
+    ReportDataModel historyModel;
+    historyModel.setWorkMode(ReportDataModel::HISTORY_MODE);
+    historyModel.generateHistoryReport(data.reportConfig(), aligned, timeAxis);
+
+    // ===== 公式计算（整列区域） =====
+    FormulaEngine engine;
+    const QString lastRow = QString::number(points + 1);
+    const int formulaCol = options.tags + 1;
+    const struct { const char* name; QString formula; } formulas[] = {
+        { "formula.sum", "=SUM(B2:B" + lastRow + ")" },
+        { "formula.max", "=MAX(B2:B" + lastRow + ")" },
+        { "formula.twavg", "=TWAVG(B2:B" + lastRow + ")" },
+        { "formula.arithmetic", "=B2*2+B3/3-B4" },
+    };
+    for (const auto& item : formulas) {
+        qint64 items = QString(item.name) == "formula.arithmetic" ? 1 : points;
+        runner.run(item.name, items, [&]() {
+            QVariant value = engine.evaluate(item.formula, &historyModel, 1, formulaCol);
+            Q_UNUSED(value)
+        });
+    }
+
+    QTemporaryDir tempDir;
+
+    // ===== 历史报表导出 =====
+    const QString historyFile = tempDir.filePath("history.xlsx");
+    runner.run("history.export", points * options.tags, [&]() {
+        historyModel.exportHistoryReportToExcel(historyFile);
+    });
+
+    // ===== 实时报表 Excel 读写 =====
+    ReportDataModel realtimeModel;
+    realtimeModel.setWorkMode(ReportDataModel::REALTIME_MODE);
+    for (int row = 0; row < excelRows; ++row) {
+        for (int col = 0; col < excelCols; ++col) {
+            QVariant value = (col == 0) ? QVariant(QString("行%1").arg(row + 1)) : QVariant(row * 0.5 + col);
+            realtimeModel.setData(realtimeModel.index(row, col), value, Qt::EditRole);
+        }
+    }
+
+    const QString realtimeFile = tempDir.filePath("realtime.xlsx");
+    realtimeModel.saveToExcel(realtimeFile);
+    runner.run("excel.save", static_cast<qint64>(excelRows) * excelCols, [&]() {
+        realtimeModel.saveToExcel(realtimeFile);
+    });
+
+    ReportDataModel loadModel;
+    runner.run("excel.load", static_cast<qint64>(excelRows) * excelCols, [&]() {
+        loadModel.loadFromExcel(realtimeFile);
+    });
+
+    // ===== 结果 =====
+    QJsonObject parameters;
+    parameters["tags"] = options.tags;
+    parameters["days"] = options.days;
+    parameters["intervalSeconds"] = options.intervalSeconds;
+    parameters["jitterSeconds"] = options.jitterSeconds;
+    parameters["gapRatio"] = options.gapRatio;
+    parameters["points"] = static_cast<double>(points);
+    parameters["samples"] = static_cast<double>(data.totalSamples());
+    parameters["excelCells"] = excelRows * excelCols;
+
+    const QString outputFile = parser.value(outputOption);
+    if (!runner.writeJson(outputFile, parameters)) {
+        QTextStream(stderr) << "无法写入结果文件：" << outputFile << Qt::endl;
+        return 1;
+    }
+    QTextStream(stdout) << "结果已写入 " << outputFile << Qt::endl;
+    return 0;
+}
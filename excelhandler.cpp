@@ -1,6 +1,7 @@
 ﻿#include "excelhandler.h"
 #include "reportdatamodel.h"
 #include "DataBindingConfig.h"
+#include "PipelineTrace.h"
 
 #include <QMessageBox>
 #include <QFileInfo>
@@ -21,6 +22,7 @@
 
 bool ExcelHandler::loadFromFile(const QString& fileName, ReportDataModel* model)
 {
+    TRACE_SCOPE("excel.load");
     if (fileName.isEmpty() || !model) {
         QMessageBox::warning(nullptr, "错误", "参数无效");
         return false;
@@ -217,6 +219,7 @@ void ExcelHandler::loadRowColumnSizes(QXlsx::Worksheet* worksheet, ReportDataMod
 
 bool ExcelHandler::saveToFile(const QString& fileName, ReportDataModel* model)
 {
+    TRACE_SCOPE("excel.save");
     if (fileName.isEmpty() || !model) {
         QMessageBox::warning(nullptr, "错误", "参数无效");
         return false;
@@ -1,8 +1,107 @@
 ﻿#include "formulaengine.h"
 #include "reportdatamodel.h"
+#include "TimeSeriesKernels.h"
+#include "PipelineTrace.h"
 #include <QRegularExpression>
-#include <QStack>
-#include <QQueue>
+#include <limits>
+#include <cmath>
+
+// ===== FormulaValue =====
+
+FormulaValue FormulaValue::fromNumber(double v)
+{
+    FormulaValue value;
+    value.type = Number;
+    value.number = v;
+    return value;
+}
+
+FormulaValue FormulaValue::fromString(const QString& s)
+{
+    FormulaValue value;
+    value.type = String;
+    value.text = s;
+    return value;
+}
+
+FormulaValue FormulaValue::fromError(ErrorCode code)
+{
+    FormulaValue value;
+    value.type = Error;
+    value.error = code;
+    return value;
+}
+
+FormulaValue FormulaValue::fromVariant(const QVariant& v)
+{
+    switch (static_cast<QMetaType::Type>(v.userType())) {
+    case QMetaType::UnknownType:
+        return FormulaValue();
+    case QMetaType::Double:
+    case QMetaType::Float:
+    case QMetaType::Int:
+    case QMetaType::UInt:
+    case QMetaType::LongLong:
+    case QMetaType::ULongLong:
+    case QMetaType::Bool:
+        return fromNumber(v.toDouble());
+    default:
+        break;
+    }
+
+    const QString s = v.toString();
+    if (s.isEmpty()) {
+        return FormulaValue();
+    }
+
+    // 其他公式单元格的错误结果要继续向上传播
+    if (s.startsWith('#')) {
+        for (int code = DivByZero; code <= Syntax; ++code) {
+            if (s == errorText(static_cast<ErrorCode>(code))) {
+                return fromError(static_cast<ErrorCode>(code));
+            }
+        }
+    }
+
+    // 数字文本在边界处一次性转换，计算时不再反复 toDouble
+    bool ok = false;
+    double d = s.toDouble(&ok);
+    return ok ? fromNumber(d) : fromString(s);
+}
+
+QVariant FormulaValue::toVariant() const
+{
+    switch (type) {
+    case Number: return QVariant(number);
+    case String: return QVariant(text);
+    case Error:  return QVariant(errorText(error));
+    default:     return QVariant();
+    }
+}
+
+bool FormulaValue::toNumber(double& out) const
+{
+    switch (type) {
+    case Number: out = number; return true;
+    case Error:  return false;
+    default:     out = 0.0; return true;   // 空单元格和非数字文本当作0处理
+    }
+}
+
+QString FormulaValue::errorText(ErrorCode code)
+{
+    switch (code) {
+    case DivByZero:    return QStringLiteral("#DIV/0!");
+    case BadRef:       return QStringLiteral("#REF!");
+    case BadValue:     return QStringLiteral("#VALUE!");
+    case BadName:      return QStringLiteral("#NAME?");
+    case NotAvailable: return QStringLiteral("#N/A");
+    case Syntax:       return QStringLiteral("#ERROR!");
+    default:           return QString();
+    }
+}
+
+// ===== FormulaEngine =====
 
 FormulaEngine::FormulaEngine(QObject* parent) : QObject(parent)
 {
@@ -10,45 +109,29 @@ FormulaEngine::FormulaEngine(QObject* parent) : QObject(parent)
 
 QVariant FormulaEngine::evaluate(const QString& formula, ReportDataModel* model, int currentRow, int currentCol)
 {
+    TRACE_SCOPE("formula.evaluate");
     Q_UNUSED(currentRow)
         Q_UNUSED(currentCol)
 
         if (!isFormula(formula))
             return formula;
 
-    QString expr = formula.mid(1).trimmed(); // 去掉 '='
+    EvalContext ctx(formula, model);
+    ctx.pos = 1; // 跳过 '='
 
-    // 优先检查是否为函数调用
-    QRegularExpression functionRegex(R"(^(SUM|MAX|MIN)\s*\([^)]+\)$)");
-    QRegularExpressionMatch functionMatch = functionRegex.match(expr);
+    FormulaValue result = parseExpression(ctx);
 
-    if (functionMatch.hasMatch()) {
-        // 处理函数
-        if (expr.startsWith("SUM")) {
-            QRegularExpression sumRegex(R"(SUM\(([A-Z]+\d+:[A-Z]+\d+)\))");
-            QRegularExpressionMatch match = sumRegex.match(expr);
-            if (match.hasMatch()) {
-                return evaluateSum(match.captured(1), model);
-            }
-        }
-        else if (expr.startsWith("MAX")) {
-            QRegularExpression maxRegex(R"(MAX\(([A-Z]+\d+:[A-Z]+\d+)\))");
-            QRegularExpressionMatch match = maxRegex.match(expr);
-            if (match.hasMatch()) {
-                return evaluateMax(match.captured(1), model);
-            }
-        }
-        else if (expr.startsWith("MIN")) {
-            QRegularExpression minRegex(R"(MIN\(([A-Z]+\d+:[A-Z]+\d+)\))");
-            QRegularExpressionMatch match = minRegex.match(expr);
-            if (match.hasMatch()) {
-                return evaluateMin(match.captured(1), model);
-            }
-        }
+    ctx.skipSpaces();
+    if (ctx.syntaxError || !ctx.atEnd()) {
+        result = FormulaValue::fromError(FormulaValue::Syntax);
+    }
+
+    // 与原实现保持一致：引用空单元格的结果显示为0
+    if (result.type == FormulaValue::Empty) {
+        result = FormulaValue::fromNumber(0.0);
     }
 
-    // 如果不是函数，尝试作为表达式处理
-    return evaluateExpression(expr, model);
+    return result.toVariant();
 }
 
 bool FormulaEngine::isFormula(const QString& text) const
@@ -56,281 +139,673 @@ bool FormulaEngine::isFormula(const QString& text) const
 	return !text.isEmpty() && text.startsWith('=');
 }
 
-// 
-QVariant FormulaEngine::evaluateSum(const QString& range, ReportDataModel* model)
+FormulaTemplate FormulaEngine::compileTemplate(const QString& formula)
 {
-    QPair<QPoint, QPoint> cellRange = parseRange(range);
-    if (cellRange.first.x() == -1 || cellRange.second.x() == -1) {
-        return QVariant(0.0);
+    FormulaTemplate tmpl;
+
+    // 匹配单元格引用：支持 $A$1, $A1, A$1, A1（只在编译时跑一次正则）
+    static const QRegularExpression regex(R"((\$?)([A-Z]+)(\$?)(\d+))");
+    QRegularExpressionMatchIterator it = regex.globalMatch(formula);
+
+    int lastEnd = 0;
+    while (it.hasNext()) {
+        QRegularExpressionMatch match = it.next();
+
+        if (match.capturedStart() > lastEnd) {
+            FormulaTemplate::Segment literal;
+            literal.text = formula.mid(lastEnd, match.capturedStart() - lastEnd);
+            tmpl.segments.append(literal);
+        }
+
+        FormulaTemplate::Segment ref;
+        ref.isReference = true;
+        ref.text = match.captured(1) + match.captured(2) + match.captured(3);
+        ref.rowAbsolute = !match.captured(3).isEmpty();
+        ref.row = match.captured(4).toInt();
+        tmpl.segments.append(ref);
+
+        lastEnd = match.capturedEnd();
     }
 
-    double sum = 0.0;
-    for (int row = cellRange.first.x(); row <= cellRange.second.x(); ++row) {
-        for (int col = cellRange.first.y(); col <= cellRange.second.y(); ++col) {
-            const CellData* cell = model->getCell(row, col);
-            if (cell) {
-                bool ok;
-                double value = cell->value.toDouble(&ok);
-                if (ok) {
-                    sum += value;
+    if (lastEnd < formula.length()) {
+        FormulaTemplate::Segment literal;
+        literal.text = formula.mid(lastEnd);
+        tmpl.segments.append(literal);
+    }
+
+    return tmpl;
+}
+
+// 公式引用到的单元格区域（QRect 的 x 为行、y 为列，与模型单元格键一致），用于建立依赖索引
+QVector<QRect> FormulaEngine::referencedRanges(const QString& formula) const
+{
+    QVector<QRect> ranges;
+    QString expr = formula.startsWith('=') ? formula.mid(1) : formula;
+    EvalContext ctx(expr, nullptr);
+
+    while (!ctx.atEnd()) {
+        QChar c = ctx.peek();
+
+        // 跳过字符串字面量
+        if (c == '"') {
+            ++ctx.pos;
+            while (!ctx.atEnd() && ctx.peek() != '"') ++ctx.pos;
+            ++ctx.pos;
+            continue;
+        }
+
+        // 引用只能出现在标识符边界上
+        bool boundary = ctx.pos == 0 ||
+            !(expr[ctx.pos - 1].isLetterOrNumber() || expr[ctx.pos - 1] == '_');
+        QPoint from;
+        if (boundary && (c == '$' || c.isLetter()) && readReference(ctx, from)) {
+            QPoint to = from;
+            int save = ctx.pos;
+            ctx.skipSpaces();
+            if (ctx.peek() == ':') {
+                ++ctx.pos;
+                ctx.skipSpaces();
+                if (!readReference(ctx, to)) {
+                    to = from;
+                    ctx.pos = save;
                 }
             }
+            else {
+                ctx.pos = save;
+            }
+            ranges.append(QRect(from, to).normalized());
+            continue;
+        }
+
+        // 跳过整个标识符（函数名等）
+        if (c.isLetter() || c == '_' || c == '$') {
+            while (!ctx.atEnd() && (ctx.peek().isLetterOrNumber() || ctx.peek() == '_' || ctx.peek() == '$')) ++ctx.pos;
+            continue;
         }
+        ++ctx.pos;
     }
-    return QVariant(sum);
+    return ranges;
 }
 
-QVariant FormulaEngine::evaluateMax(const QString& range, ReportDataModel* model)
+QString FormulaTemplate::instantiate(int rowOffset) const
 {
-    QPair<QPoint, QPoint> cellRange = parseRange(range);
-    if (cellRange.first.x() == -1 || cellRange.second.x() == -1) {
-        return QVariant();
+    QString result;
+    result.reserve(64);
+
+    for (const Segment& seg : segments) {
+        result += seg.text;
+        if (seg.isReference) {
+            // 只有非绝对引用才调整
+            result += QString::number(seg.rowAbsolute ? seg.row : seg.row + rowOffset);
+        }
     }
+    return result;
+}
 
-    double maxValue = std::numeric_limits<double>::lowest();
-    bool hasValue = false;
+void FormulaEngine::EvalContext::skipSpaces()
+{
+    while (pos < expr.length() && expr[pos].isSpace()) {
+        ++pos;
+    }
+}
 
-    for (int row = cellRange.first.x(); row <= cellRange.second.x(); ++row) {
-        for (int col = cellRange.first.y(); col <= cellRange.second.y(); ++col) {
-            const CellData* cell = model->getCell(row, col);
-            if (cell) {
-                bool ok;
-                double value = cell->value.toDouble(&ok);
-                if (ok) {
-                    if (!hasValue || value > maxValue) {
-                        maxValue = value;
-                        hasValue = true;
-                    }
-                }
-            }
+// expression := term (('+' | '-') term)*
+FormulaValue FormulaEngine::parseExpression(EvalContext& ctx)
+{
+    FormulaValue left = parseTerm(ctx);
+
+    for (;;) {
+        ctx.skipSpaces();
+        QChar op = ctx.peek();
+        if (op != '+' && op != '-') break;
+
+        ++ctx.pos;
+        FormulaValue right = parseTerm(ctx);
+        left = applyOperator(left, right, op);
+    }
+    return left;
+}
+
+// term := factor (('*' | '/') factor)*
+FormulaValue FormulaEngine::parseTerm(EvalContext& ctx)
+{
+    FormulaValue left = parseFactor(ctx);
+
+    for (;;) {
+        ctx.skipSpaces();
+        QChar op = ctx.peek();
+        if (op != '*' && op != '/') break;
+
+        ++ctx.pos;
+        FormulaValue right = parseFactor(ctx);
+        left = applyOperator(left, right, op);
+    }
+    return left;
+}
+
+// factor := ('-' | '+') factor | number | reference | function '(' args ')' | '(' expression ')'
+FormulaValue FormulaEngine::parseFactor(EvalContext& ctx)
+{
+    ctx.skipSpaces();
+    QChar c = ctx.peek();
+
+    if (c == '-' || c == '+') {
+        ++ctx.pos;
+        FormulaValue operand = parseFactor(ctx);
+        if (c == '+' || operand.isError()) return operand;
+
+        double v = 0.0;
+        operand.toNumber(v);
+        return FormulaValue::fromNumber(-v);
+    }
+
+    if (c.isDigit() || c == '.') {
+        return parseNumber(ctx);
+    }
+
+    if (c == '"') {
+        return parseString(ctx);
+    }
+
+    if (c == '(') {
+        ++ctx.pos;
+        FormulaValue inner = parseExpression(ctx);
+        ctx.skipSpaces();
+        if (ctx.peek() != ')') {
+            ctx.syntaxError = true;
+            return FormulaValue::fromError(FormulaValue::Syntax);
         }
+        ++ctx.pos;
+        return inner;
+    }
+
+    if (c.isLetter() || c == '$') {
+        return parseIdentifier(ctx);
     }
-    return hasValue ? QVariant(maxValue) : QVariant(0.0);
+
+    ctx.syntaxError = true;
+    return FormulaValue::fromError(FormulaValue::Syntax);
 }
 
-QVariant FormulaEngine::evaluateMin(const QString& range, ReportDataModel* model)
+FormulaValue FormulaEngine::parseNumber(EvalContext& ctx)
 {
-    QPair<QPoint, QPoint> cellRange = parseRange(range);
-    if (cellRange.first.x() == -1 || cellRange.second.x() == -1) {
-        return QVariant();
+    int start = ctx.pos;
+    while (!ctx.atEnd() && (ctx.peek().isDigit() || ctx.peek() == '.')) {
+        ++ctx.pos;
     }
 
-    double minValue = std::numeric_limits<double>::max();
-    bool hasValue = false;
+    bool ok = false;
+    double v = ctx.expr.midRef(start, ctx.pos - start).toDouble(&ok);
+    if (!ok) {
+        ctx.syntaxError = true;
+        return FormulaValue::fromError(FormulaValue::Syntax);
+    }
+    return FormulaValue::fromNumber(v);
+}
 
-    for (int row = cellRange.first.x(); row <= cellRange.second.x(); ++row) {
-        for (int col = cellRange.first.y(); col <= cellRange.second.y(); ++col) {
-            const CellData* cell = model->getCell(row, col);
-            if (cell) {
-                bool ok;
-                double value = cell->value.toDouble(&ok);
-                if (ok) {
-                    if (!hasValue || value < minValue) {
-                        minValue = value;
-                        hasValue = true;
-                    }
-                }
+// 字符串常量，"" 表示一个双引号（COUNTIF 条件如 ">85"）
+FormulaValue FormulaEngine::parseString(EvalContext& ctx)
+{
+    ++ctx.pos; // 跳过起始引号
+
+    QString text;
+    while (!ctx.atEnd()) {
+        QChar c = ctx.peek();
+        ++ctx.pos;
+        if (c == '"') {
+            if (ctx.peek() == '"') {
+                text += c;
+                ++ctx.pos;
+                continue;
             }
+            return FormulaValue::fromString(text);
         }
+        text += c;
     }
-    return hasValue ? QVariant(minValue) : QVariant(0.0);
-}
 
+    ctx.syntaxError = true;
+    return FormulaValue::fromError(FormulaValue::Syntax);
+}
 
-QVariant FormulaEngine::evaluateExpression(const QString& expression, ReportDataModel* model)
+// 单元格引用或函数调用
+FormulaValue FormulaEngine::parseIdentifier(EvalContext& ctx)
 {
-    // 1. 预处理：将单元格引用替换为实际值
-    QString processedExpr = preprocessExpression(expression, model);
+    int start = ctx.pos;
+
+    QPoint cell;
+    if (readReference(ctx, cell)) {
+        return getCellValue(cell.x(), cell.y(), ctx.model);
+    }
+
+    // 不是引用，按函数名读取
+    ctx.pos = start;
+    while (!ctx.atEnd() && (ctx.peek().isLetterOrNumber() || ctx.peek() == '_')) {
+        ++ctx.pos;
+    }
+    QString name = ctx.expr.mid(start, ctx.pos - start).toUpper();
+
+    ctx.skipSpaces();
+    if (name.isEmpty() || ctx.peek() != '(') {
+        ctx.syntaxError = true;
+        return FormulaValue::fromError(FormulaValue::Syntax);
+    }
+    ++ctx.pos;
+
+    QVector<FormulaArg> args;
+    if (!parseArguments(ctx, args)) {
+        ctx.syntaxError = true;
+        return FormulaValue::fromError(FormulaValue::Syntax);
+    }
 
-    // 2. 计算算术表达式
-    return calculateArithmetic(processedExpr);
+    return callFunction(name, args, ctx.model);
 }
 
-QString FormulaEngine::preprocessExpression(const QString& expression, ReportDataModel* model)
+// 读取 A1 / $A$1 形式的引用，成功时转换为0基 (row, col)
+bool FormulaEngine::readReference(EvalContext& ctx, QPoint& cell) const
 {
-    QString result = expression;
+    int p = ctx.pos;
+    const QString& e = ctx.expr;
 
-    // 匹配单元格引用（如A1, B2, AA10等）
-    QRegularExpression cellRefRegex(R"([A-Z]+\d+)");
-    QRegularExpressionMatchIterator it = cellRefRegex.globalMatch(expression);
+    if (p < e.length() && e[p] == '$') ++p;
 
-    // 从后往前替换，避免位置偏移
-    QList<QRegularExpressionMatch> matches;
-    while (it.hasNext()) {
-        matches.append(it.next());
+    int col = 0;
+    int letters = 0;
+    while (p < e.length() && e[p].isLetter() && e[p].unicode() < 128) {
+        col = col * 26 + (e[p].toUpper().unicode() - 'A' + 1);
+        ++p;
+        ++letters;
     }
+    if (letters == 0) return false;
 
-    for (int i = matches.size() - 1; i >= 0; --i) {
-        const QRegularExpressionMatch& match = matches[i];
-        QString cellRef = match.captured(0);
-        QVariant cellValue = getCellValue(cellRef, model);
+    if (p < e.length() && e[p] == '$') ++p;
 
-        // 将单元格值转换为数字字符串
-        bool ok;
-        double numValue = cellValue.toDouble(&ok);
-        if (!ok) {
-            numValue = 0.0; // 如果不是数字，当作0处理
+    int row = 0;
+    int digits = 0;
+    while (p < e.length() && e[p].isDigit()) {
+        row = row * 10 + e[p].digitValue();
+        ++p;
+        ++digits;
+    }
+    if (digits == 0) return false;
+
+    // 引用后面紧跟字母/下划线说明是函数名（如 LOG10_X），不是引用
+    if (p < e.length() && (e[p].isLetter() || e[p] == '_')) return false;
+
+    ctx.pos = p;
+    cell = QPoint(row - 1, col - 1);
+    return true;
+}
+
+// 参数列表（'(' 已消费）：每个参数是区域 A1:B3 或普通表达式
+bool FormulaEngine::parseArguments(EvalContext& ctx, QVector<FormulaArg>& args)
+{
+    ctx.skipSpaces();
+    if (ctx.peek() == ')') {
+        ++ctx.pos;
+        return true;
+    }
+
+    for (;;) {
+        ctx.skipSpaces();
+        FormulaArg arg;
+
+        int start = ctx.pos;
+        QPoint from;
+        bool isRange = false;
+        if (readReference(ctx, from)) {
+            ctx.skipSpaces();
+            if (ctx.peek() == ':') {
+                ++ctx.pos;
+                ctx.skipSpaces();
+                QPoint to;
+                if (!readReference(ctx, to)) return false;
+
+                arg.isRange = true;
+                arg.from = QPoint(qMin(from.x(), to.x()), qMin(from.y(), to.y()));
+                arg.to = QPoint(qMax(from.x(), to.x()), qMax(from.y(), to.y()));
+                isRange = true;
+            }
         }
 
-        result.replace(match.capturedStart(), match.capturedLength(), QString::number(numValue));
+        if (!isRange) {
+            ctx.pos = start;
+            arg.value = parseExpression(ctx);
+            if (ctx.syntaxError) return false;
+        }
+        args.append(arg);
+
+        ctx.skipSpaces();
+        QChar c = ctx.peek();
+        ++ctx.pos;
+        if (c == ')') return true;
+        if (c != ',') return false;
     }
+}
 
-    return result;
+FormulaValue FormulaEngine::applyOperator(const FormulaValue& left, const FormulaValue& right, QChar op) const
+{
+    // 错误按从左到右的顺序传播
+    if (left.isError()) return left;
+    if (right.isError()) return right;
+
+    double l = 0.0;
+    double r = 0.0;
+    left.toNumber(l);
+    right.toNumber(r);
+
+    switch (op.unicode()) {
+    case '+': return FormulaValue::fromNumber(l + r);
+    case '-': return FormulaValue::fromNumber(l - r);
+    case '*': return FormulaValue::fromNumber(l * r);
+    case '/':
+        if (r == 0.0) return FormulaValue::fromError(FormulaValue::DivByZero);
+        return FormulaValue::fromNumber(l / r);
+    default:
+        return FormulaValue::fromError(FormulaValue::Syntax);
+    }
 }
 
-QVariant FormulaEngine::calculateArithmetic(const QString& expression)
+FormulaValue FormulaEngine::callFunction(const QString& name, const QVector<FormulaArg>& args, ReportDataModel* model)
 {
-    // 使用调度场算法（Shunting Yard Algorithm）计算表达式
-    QStack<double> numbers;
-    QStack<QChar> operators;
+    if (name == QLatin1String("SUM")) return evaluateSum(args, model);
+    if (name == QLatin1String("MAX")) return evaluateMax(args, model);
+    if (name == QLatin1String("MIN")) return evaluateMin(args, model);
+    if (isTimeSeriesFunction(name)) return evaluateTimeSeries(name, args, model);
 
-    QString cleanExpr = expression;
-    cleanExpr.remove(' '); // 移除空格
+    return FormulaValue::fromError(FormulaValue::BadName);
+}
 
-    int i = 0;
-    while (i < cleanExpr.length()) {
-        QChar c = cleanExpr[i];
+FormulaValue FormulaEngine::evaluateSum(const QVector<FormulaArg>& args, ReportDataModel* model)
+{
+    double sum = 0.0;
 
-        if (c.isDigit() || c == '.') {
-            // 读取完整的数字
-            QString numStr;
-            while (i < cleanExpr.length() && (cleanExpr[i].isDigit() || cleanExpr[i] == '.')) {
-                numStr += cleanExpr[i];
-                i++;
-            }
-            numbers.push(numStr.toDouble());
+    for (const FormulaArg& arg : args) {
+        if (!arg.isRange) {
+            double v = 0.0;
+            if (!arg.value.toNumber(v)) return arg.value;
+            sum += v;
             continue;
         }
-        else if (c == '(') {
-            operators.push(c);
-        }
-        else if (c == ')') {
-            while (!operators.isEmpty() && operators.top() != '(') {
-                QChar op = operators.pop();
-                if (numbers.size() < 2) return QVariant("#ERROR!"); // 错误
-                double right = numbers.pop();
-                double left = numbers.pop();
-                numbers.push(applyOperator(left, right, op));
+
+        for (int row = arg.from.x(); row <= arg.to.x(); ++row) {
+            for (int col = arg.from.y(); col <= arg.to.y(); ++col) {
+                FormulaValue v = getCellValue(row, col, model);
+                if (v.isError()) return v;
+                if (v.isNumber()) sum += v.number;   // 区域内文本和空单元格忽略
             }
-            if (!operators.isEmpty()) operators.pop(); // 移除 '('
         }
-        else if (isOperator(c)) {
-            while (!operators.isEmpty() &&
-                operators.top() != '(' &&
-                getOperatorPrecedence(operators.top()) >= getOperatorPrecedence(c)) {
-                QChar op = operators.pop();
-                if (numbers.size() < 2) return QVariant("#ERROR!"); // 错误
-                double right = numbers.pop();
-                double left = numbers.pop();
-                numbers.push(applyOperator(left, right, op));
-            }
-            operators.push(c);
+    }
+    return FormulaValue::fromNumber(sum);
+}
+
+FormulaValue FormulaEngine::evaluateMax(const QVector<FormulaArg>& args, ReportDataModel* model)
+{
+    double maxValue = std::numeric_limits<double>::lowest();
+    bool hasValue = false;
+
+    auto accept = [&](double value) {
+        if (!hasValue || value > maxValue) {
+            maxValue = value;
+            hasValue = true;
         }
+    };
 
-        i++;
-    }
+    for (const FormulaArg& arg : args) {
+        if (!arg.isRange) {
+            double v = 0.0;
+            if (!arg.value.toNumber(v)) return arg.value;
+            accept(v);
+            continue;
+        }
 
-    // 处理剩余的操作符
-    while (!operators.isEmpty()) {
-        QChar op = operators.pop();
-        if (numbers.size() < 2) return QVariant("#ERROR!"); // 错误
-        double right = numbers.pop();
-        double left = numbers.pop();
-        numbers.push(applyOperator(left, right, op));
+        for (int row = arg.from.x(); row <= arg.to.x(); ++row) {
+            for (int col = arg.from.y(); col <= arg.to.y(); ++col) {
+                FormulaValue v = getCellValue(row, col, model);
+                if (v.isError()) return v;
+                if (v.isNumber()) accept(v.number);
+            }
+        }
     }
+    return FormulaValue::fromNumber(hasValue ? maxValue : 0.0);
+}
 
-    if (numbers.size() == 1) {
-        return numbers.top();
-    }
+FormulaValue FormulaEngine::evaluateMin(const QVector<FormulaArg>& args, ReportDataModel* model)
+{
+    double minValue = std::numeric_limits<double>::max();
+    bool hasValue = false;
 
-    return QVariant("#ERROR!"); // 表达式错误
+    auto accept = [&](double value) {
+        if (!hasValue || value < minValue) {
+            minValue = value;
+            hasValue = true;
+        }
+    };
+
+    for (const FormulaArg& arg : args) {
+        if (!arg.isRange) {
+            double v = 0.0;
+            if (!arg.value.toNumber(v)) return arg.value;
+            accept(v);
+            continue;
+        }
+
+        for (int row = arg.from.x(); row <= arg.to.x(); ++row) {
+            for (int col = arg.from.y(); col <= arg.to.y(); ++col) {
+                FormulaValue v = getCellValue(row, col, model);
+                if (v.isError()) return v;
+                if (v.isNumber()) accept(v.number);
+            }
+        }
+    }
+    return FormulaValue::fromNumber(hasValue ? minValue : 0.0);
 }
 
-QVariant FormulaEngine::getCellValue(const QString& cellRef, ReportDataModel* model)
+FormulaValue FormulaEngine::getCellValue(int row, int col, ReportDataModel* model) const
 {
-    QPoint pos = parseReference(cellRef);
-    if (pos.x() == -1 || pos.y() == -1) {
-        return QVariant(0.0);
+    if (row < 0 || col < 0 || !model) {
+        return FormulaValue::fromError(FormulaValue::BadRef);
     }
 
-    const CellData* cell = model->getCell(pos.x(), pos.y());
+    const CellData* cell = model->getCell(row, col);
     if (!cell) {
-        return QVariant(0.0);
+        // 历史报表的时间列和数据列不在单元格表中
+        QVariant historyValue;
+        if (model->historyValueAt(row, col, historyValue)) {
+            return FormulaValue::fromVariant(historyValue);
+        }
+        return FormulaValue();
     }
 
-    return cell->value;
+    return FormulaValue::fromVariant(cell->value);
 }
 
-double FormulaEngine::applyOperator(double left, double right, QChar op)
+bool FormulaEngine::isTimeSeriesFunction(const QString& name) const
 {
-    switch (op.unicode()) {
-    case '+': return left + right;
-    case '-': return left - right;
-    case '*': return left * right;
-    case '/': return (right != 0) ? left / right : 0;
-    default: return 0;
-    }
+    return name == QLatin1String("TWAVG") || name == QLatin1String("INTEG")
+        || name == QLatin1String("DELTA") || name == QLatin1String("RATE")
+        || name == QLatin1String("DURATION_ABOVE") || name == QLatin1String("COUNTIF");
 }
 
-int FormulaEngine::getOperatorPrecedence(QChar op)
+// TWAVG(区域)                      时间加权平均
+// INTEG(区域[, 单位秒=3600])         梯形积分，默认按小时（kW → kWh）
+// DELTA(区域)                      累计量差值，回落视为复位
+// RATE(区域[, 单位秒=3600])          DELTA / 时长，默认每小时
+// DURATION_ABOVE(区域, 阈值[, 单位秒=3600])  超限时长，默认小时
+// COUNTIF(区域, 条件)               条件为数字或 ">85" / "<=10" / "<>0" 等
+FormulaValue FormulaEngine::evaluateTimeSeries(const QString& name, const QVector<FormulaArg>& args, ReportDataModel* model)
 {
-    switch (op.unicode()) {
-    case '+': case '-': return 1;
-    case '*': case '/': return 2;
-    default: return 0;
+    if (args.isEmpty()) {
+        return FormulaValue::fromError(FormulaValue::BadValue);
     }
-}
 
-bool FormulaEngine::isOperator(QChar c)
-{
-    return c == '+' || c == '-' || c == '*' || c == '/';
-}
+    const bool isCountIf = (name == QLatin1String("COUNTIF"));
 
-QPoint FormulaEngine::parseReference(const QString& ref) const
-{
-    if (!isValidCellReference(ref)) {
-        return QPoint(-1, -1);
+    SeriesView series;
+    FormulaValue error;
+    if (!resolveSeries(args[0], model, !isCountIf, series, error)) {
+        return error;
     }
 
-    // 分离字母和数字部分
-    QRegularExpression regex(R"(([A-Z]+)(\d+))");
-    QRegularExpressionMatch match = regex.match(ref);
+    const qint64* t = series.times;
+    const double* v = series.values;
+    const int n = series.count;
+
+    if (isCountIf) {
+        if (args.size() != 2) return FormulaValue::fromError(FormulaValue::BadValue);
+
+        const FormulaValue& criteria = args[1].value;
+        if (args[1].isRange || criteria.isError()) {
+            return criteria.isError() ? criteria : FormulaValue::fromError(FormulaValue::BadValue);
+        }
+
+        TimeSeriesKernels::CompareOp op = TimeSeriesKernels::CompareOp::Equal;
+        double operand = criteria.number;
+
+        if (criteria.type == FormulaValue::String) {
+            QString text = criteria.text.trimmed();
+            static const struct { const char* prefix; TimeSeriesKernels::CompareOp op; } prefixes[] = {
+                { ">=", TimeSeriesKernels::CompareOp::GreaterEqual },
+                { "<=", TimeSeriesKernels::CompareOp::LessEqual },
+                { "<>", TimeSeriesKernels::CompareOp::NotEqual },
+                { ">",  TimeSeriesKernels::CompareOp::Greater },
+                { "<",  TimeSeriesKernels::CompareOp::Less },
+                { "=",  TimeSeriesKernels::CompareOp::Equal },
+            };
+            for (const auto& p : prefixes) {
+                if (text.startsWith(QLatin1String(p.prefix))) {
+                    op = p.op;
+                    text = text.mid(static_cast<int>(qstrlen(p.prefix))).trimmed();
+                    break;
+                }
+            }
+
+            bool ok = false;
+            operand = text.toDouble(&ok);
+            if (!ok) return FormulaValue::fromError(FormulaValue::BadValue);
+        }
+        else if (criteria.type != FormulaValue::Number) {
+            return FormulaValue::fromError(FormulaValue::BadValue);
+        }
 
-    if (!match.hasMatch()) {
-        return QPoint(-1, -1);
+        return FormulaValue::fromNumber(TimeSeriesKernels::countIf(v, n, op, operand));
     }
 
-    QString colStr = match.captured(1);
-    int rowNum = match.captured(2).toInt();
+    double result = std::numeric_limits<double>::quiet_NaN();
 
-    // 转换列名为列索引
-    int col = 0;
-    for (int i = 0; i < colStr.length(); ++i) {
-        col = col * 26 + (colStr[i].unicode() - 'A' + 1);
+    if (name == QLatin1String("TWAVG")) {
+        if (args.size() != 1) return FormulaValue::fromError(FormulaValue::BadValue);
+        result = TimeSeriesKernels::timeWeightedAverage(t, v, n);
+    }
+    else if (name == QLatin1String("INTEG")) {
+        double unit = 0.0;
+        if (args.size() > 2) return FormulaValue::fromError(FormulaValue::BadValue);
+        if (!numberArgument(args, 1, 3600.0, unit, error)) return error;
+        if (unit <= 0) return FormulaValue::fromError(FormulaValue::BadValue);
+
+        double covered = 0.0;
+        double area = TimeSeriesKernels::integrate(t, v, n, &covered);
+        if (covered > 0) result = area / unit;
+    }
+    else if (name == QLatin1String("DELTA")) {
+        if (args.size() != 1) return FormulaValue::fromError(FormulaValue::BadValue);
+        result = TimeSeriesKernels::counterDelta(t, v, n);
+    }
+    else if (name == QLatin1String("RATE")) {
+        double unit = 0.0;
+        if (args.size() > 2) return FormulaValue::fromError(FormulaValue::BadValue);
+        if (!numberArgument(args, 1, 3600.0, unit, error)) return error;
+
+        double elapsed = 0.0;
+        double delta = TimeSeriesKernels::counterDelta(t, v, n, &elapsed);
+        if (std::isnan(delta)) return FormulaValue::fromError(FormulaValue::NotAvailable);
+        if (elapsed <= 0) return FormulaValue::fromError(FormulaValue::DivByZero);
+        result = delta / elapsed * unit;
+    }
+    else if (name == QLatin1String("DURATION_ABOVE")) {
+        double threshold = 0.0;
+        double unit = 0.0;
+        if (args.size() < 2 || args.size() > 3) return FormulaValue::fromError(FormulaValue::BadValue);
+        if (!numberArgument(args, 1, 0.0, threshold, error)) return error;
+        if (!numberArgument(args, 2, 3600.0, unit, error)) return error;
+        if (unit <= 0) return FormulaValue::fromError(FormulaValue::BadValue);
+
+        result = TimeSeriesKernels::durationAbove(t, v, n, threshold) / unit;
     }
-    col -= 1; // 转换为0基索引
 
-    return QPoint(rowNum - 1, col); // 转换为0基索引
+    if (std::isnan(result)) {
+        return FormulaValue::fromError(FormulaValue::NotAvailable);
+    }
+    return FormulaValue::fromNumber(result);
 }
 
-// 解析范围字符串，如 "A1:B3"
-QPair<QPoint, QPoint> FormulaEngine::parseRange(const QString& range) const
+// 把单列区域解析为 (时间, 数值) 序列；历史数据列直接指向对齐数组，不做拷贝
+bool FormulaEngine::resolveSeries(const FormulaArg& arg, ReportDataModel* model, bool needTime, SeriesView& view, FormulaValue& error)
 {
-    QStringList parts = range.split(':');
-    if (parts.size() != 2) {
-        return qMakePair(QPoint(-1, -1), QPoint(-1, -1));
+    if (!model || !arg.isRange || arg.from.y() != arg.to.y()) {
+        error = FormulaValue::fromError(FormulaValue::BadValue);
+        return false;
     }
 
-    QPoint start = parseReference(parts[0].trimmed());
-    QPoint end = parseReference(parts[1].trimmed());
+    const int col = arg.from.y();
+    int first = arg.from.x();
+    int last = arg.to.x();
+
+    const QVector<qint64>& axis = model->timeAxisSeconds();
+    if (!axis.isEmpty()) {
+        // 时间轴只覆盖数据行（模型第 1..N 行），表头行自动排除
+        first = qMax(first, 1);
+        last = qMin(last, axis.size());
+        if (first > last) {
+            error = FormulaValue::fromError(FormulaValue::NotAvailable);
+            return false;
+        }
+        view.times = axis.constData() + (first - 1);
+    }
+    else if (needTime) {
+        // 没有报表时间轴（实时模式）时无法计算时间相关函数
+        error = FormulaValue::fromError(FormulaValue::NotAvailable);
+        return false;
+    }
+
+    view.count = last - first + 1;
+
+    const QVector<double>* data = model->historyColumnData(col);
+    if (data && data->size() >= last) {
+        view.values = data->constData() + (first - 1);
+        return true;
+    }
 
-    return qMakePair(start, end);
+    // 公式列或实时模式：逐格取值到临时缓冲
+    view.buffer.resize(view.count);
+    for (int i = 0; i < view.count; ++i) {
+        FormulaValue v = getCellValue(first + i, col, model);
+        if (v.isError()) {
+            error = v;
+            return false;
+        }
+        view.buffer[i] = v.isNumber() ? v.number : std::numeric_limits<double>::quiet_NaN();
+    }
+    view.values = view.buffer.constData();
+    return true;
 }
 
-bool FormulaEngine::isValidCellReference(const QString& ref) const
+bool FormulaEngine::numberArgument(const QVector<FormulaArg>& args, int index, double defaultValue, double& out, FormulaValue& error) const
 {
-    QRegularExpression regex(R"(^[A-Z]+\d+$)");
-    return regex.match(ref).hasMatch();
+    if (index >= args.size()) {
+        out = defaultValue;
+        return true;
+    }
+
+    const FormulaArg& arg = args[index];
+    if (arg.isRange) {
+        error = FormulaValue::fromError(FormulaValue::BadValue);
+        return false;
+    }
+    if (!arg.value.toNumber(out)) {
+        error = arg.value;
+        return false;
+    }
+    return true;
 }
 
 QString FormulaEngine::columnToString(int col) const
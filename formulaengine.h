@@ -4,11 +4,54 @@
 #include <QObject>
 #include <QVariant>
 #include <QString>
-#include <QStack>
+#include <QVector>
+#include <QPoint>
+#include <QRect>
 #include "DataBindingConfig.h"
 
 class ReportDataModel;
 
+// 公式计算用的紧凑值类型（数值/字符串/错误/空），QVariant 只在模型边界出现
+struct FormulaValue {
+    enum Type : quint8 { Empty, Number, String, Error };
+    enum ErrorCode : quint8 { NoError, DivByZero, BadRef, BadValue, BadName, NotAvailable, Syntax };
+
+    Type type = Empty;
+    ErrorCode error = NoError;
+    double number = 0.0;
+    QString text;
+
+    static FormulaValue fromNumber(double v);
+    static FormulaValue fromString(const QString& s);
+    static FormulaValue fromError(ErrorCode code);
+
+    // 模型边界转换
+    static FormulaValue fromVariant(const QVariant& v);
+    QVariant toVariant() const;
+
+    bool isError() const { return type == Error; }
+    bool isNumber() const { return type == Number; }
+
+    // 参与算术运算：空和非数字文本按0处理，错误返回false
+    bool toNumber(double& out) const;
+
+    static QString errorText(ErrorCode code);
+};
+
+// 公式模板：向下填充时只解析一次，按行偏移实例化相对引用
+struct FormulaTemplate {
+    struct Segment {
+        QString text;             // 字面文本；引用时为 "$A$" / "A" 这样的前缀
+        bool isReference = false;
+        bool rowAbsolute = false; // 行号带 $ 时不随填充调整
+        int row = 0;              // 引用的行号（1基）
+    };
+
+    QVector<Segment> segments;
+
+    QString instantiate(int rowOffset) const;
+};
+
 class FormulaEngine : public QObject
 {
     Q_OBJECT
@@ -19,29 +62,67 @@ public:
     QVariant evaluate(const QString& formula, ReportDataModel* model, int currentRow, int currentCol);
     bool isFormula(const QString& text) const;
 
+    // 编译填充模板（支持 $A$1, $A1, A$1, A1）
+    static FormulaTemplate compileTemplate(const QString& formula);
+
+    // 公式引用的单元格区域（单个引用为 1×1 区域）
+    QVector<QRect> referencedRanges(const QString& formula) const;
+
 private:
-    // 原有函数支持
-    QVariant evaluateSum(const QString& range, ReportDataModel* model);
-    QVariant evaluateMax(const QString& range, ReportDataModel* model);
-    QVariant evaluateMin(const QString& range, ReportDataModel* model);
+    // 解析上下文：表达式只扫描一遍，边解析边求值
+    struct EvalContext {
+        const QString& expr;
+        int pos;
+        ReportDataModel* model;
+        bool syntaxError;
+
+        EvalContext(const QString& e, ReportDataModel* m) : expr(e), pos(0), model(m), syntaxError(false) {}
+        QChar peek() const { return pos < expr.length() ? expr[pos] : QChar(); }
+        bool atEnd() const { return pos >= expr.length(); }
+        void skipSpaces();
+    };
+
+    // 函数参数：区域引用或普通值
+    struct FormulaArg {
+        bool isRange = false;
+        QPoint from;
+        QPoint to;
+        FormulaValue value;
+    };
+
+    // 递归下降求值
+    FormulaValue parseExpression(EvalContext& ctx);
+    FormulaValue parseTerm(EvalContext& ctx);
+    FormulaValue parseFactor(EvalContext& ctx);
+    FormulaValue parseNumber(EvalContext& ctx);
+    FormulaValue parseString(EvalContext& ctx);
+    FormulaValue parseIdentifier(EvalContext& ctx);
+    bool parseArguments(EvalContext& ctx, QVector<FormulaArg>& args);
+    bool readReference(EvalContext& ctx, QPoint& cell) const;
+    FormulaValue applyOperator(const FormulaValue& left, const FormulaValue& right, QChar op) const;
 
-    // 新增：表达式计算支持
-    QVariant evaluateExpression(const QString& expression, ReportDataModel* model);
-    QString preprocessExpression(const QString& expression, ReportDataModel* model);
-    QVariant calculateArithmetic(const QString& expression);
+    // 函数
+    FormulaValue callFunction(const QString& name, const QVector<FormulaArg>& args, ReportDataModel* model);
+    FormulaValue evaluateSum(const QVector<FormulaArg>& args, ReportDataModel* model);
+    FormulaValue evaluateMax(const QVector<FormulaArg>& args, ReportDataModel* model);
+    FormulaValue evaluateMin(const QVector<FormulaArg>& args, ReportDataModel* model);
 
-    // 操作符处理
-    double applyOperator(double left, double right, QChar op);
-    int getOperatorPrecedence(QChar op);
-    bool isOperator(QChar c);
+    // 时序函数（TWAVG/INTEG/DELTA/RATE/DURATION_ABOVE/COUNTIF），单列区域按报表时间轴单遍计算
+    struct SeriesView {
+        const qint64* times = nullptr;
+        const double* values = nullptr;
+        int count = 0;
+        QVector<double> buffer;   // 非历史数据列时的临时拷贝
+    };
+    bool isTimeSeriesFunction(const QString& name) const;
+    FormulaValue evaluateTimeSeries(const QString& name, const QVector<FormulaArg>& args, ReportDataModel* model);
+    bool resolveSeries(const FormulaArg& arg, ReportDataModel* model, bool needTime, SeriesView& view, FormulaValue& error);
+    bool numberArgument(const QVector<FormulaArg>& args, int index, double defaultValue, double& out, FormulaValue& error) const;
 
     // 单元格引用处理
-    QPoint parseReference(const QString& ref) const;
-    QPair<QPoint, QPoint> parseRange(const QString& range) const;
-    QVariant getCellValue(const QString& cellRef, ReportDataModel* model);
+    FormulaValue getCellValue(int row, int col, ReportDataModel* model) const;
 
     // 工具函数
-    bool isValidCellReference(const QString& ref) const;
     QString columnToString(int col) const;
 };
 
@@ -1,13 +1,42 @@
 ﻿#include <QApplication>
 #include "mainwindow.h"
+#include "BatchReportRunner.h"
+#include "ReportScheduleService.h"
+#include "PipelineTrace.h"
 
 int main(int argc, char* argv[])
 {
+    // 批处理和服务模式不需要显示设备，默认使用 offscreen 平台
+    const bool batch = BatchReportRunner::isBatchInvocation(argc, argv);
+    const bool service = ReportScheduleService::isServiceInvocation(argc, argv);
+    if ((batch || service) && qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+
     QApplication app(argc, argv);
 
-    MainWindow window;
-    window.show();
+    // 设置 SCADA_TRACE=<文件> 时记录性能跟踪，退出时写出
+    const QString traceFile = PipelineTrace::configureFromEnvironment();
 
-    return app.exec();
-}
+    int exitCode = 0;
+    if (batch) {
+        exitCode = BatchReportRunner::run(app.arguments());
+    }
+    else if (service) {
+        ReportScheduleService scheduler;
+        if (!scheduler.start(app.arguments())) {
+            return 1;
+        }
+        exitCode = app.exec();
+    }
+    else {
+        MainWindow window;
+        window.show();
+        exitCode = app.exec();
+    }
 
+    if (!traceFile.isEmpty()) {
+        PipelineTrace::writeChromeTrace(traceFile);
+    }
+    return exitCode;
+}
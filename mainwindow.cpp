@@ -3,7 +3,14 @@
 #include "mainwindow.h"
 #include "reportdatamodel.h"
 #include "EnhancedTableView.h"
-#include "TaosDataFetcher.h"
+#include "RealtimeRefreshScheduler.h"
+#include "CellTextIndex.h"
+#include "RowIndexProxyModel.h"
+#include "HistoryFilterEngine.h"
+#include "NumericFilterDialog.h"
+#include "HistorySortEngine.h"
+#include "HistoryReportPipeline.h"
+#include "PipelineTrace.h"
 
 #include <QApplication>
 #include <QFileDialog>
@@ -12,9 +19,9 @@
 #include <QLineEdit>
 #include <QInputDialog>
 #include <QProgressDialog>
-#include <QSortFilterProxyModel>
 #include <QFileInfo>
 #include <QDebug>
+#include <QElapsedTimer>
 #include <QShortcut>
 #include <QRegularExpression> 
 
@@ -24,6 +31,10 @@ MainWindow::MainWindow(QWidget* parent)
     , m_updating(false)
 	, m_formulaEditMode(false)
     , m_filterModel(nullptr)
+    , m_textIndex(nullptr)
+    , m_autoRefreshAction(nullptr)
+    , m_subscribeAction(nullptr)
+    , m_refreshScheduler(nullptr)
 {
 
     setupUI();
@@ -62,15 +73,30 @@ void MainWindow::setupToolBar()
 
     m_toolBar->addAction("刷新数据", this, &MainWindow::onRefreshData);
     m_toolBar->addAction("还原配置", this, &MainWindow::onRestoreConfig);
+    m_autoRefreshAction = m_toolBar->addAction("自动刷新");
+    m_autoRefreshAction->setCheckable(true);
+    connect(m_autoRefreshAction, &QAction::toggled, this, &MainWindow::onToggleAutoRefresh);
+    m_subscribeAction = m_toolBar->addAction("订阅刷新");
+    m_subscribeAction->setCheckable(true);
+    connect(m_subscribeAction, &QAction::toggled, this, &MainWindow::onToggleSubscription);
     m_toolBar->addSeparator();
 
     // 工具操作
     m_toolBar->addAction("查找", this, &MainWindow::onFind);
     m_toolBar->addAction("筛选", this, &MainWindow::onFilter);
+    m_toolBar->addAction("数值筛选", this, &MainWindow::onNumericFilter);
+    m_toolBar->addAction("升序排序", this, &MainWindow::onSortAscending);
+    m_toolBar->addAction("降序排序", this, &MainWindow::onSortDescending);
     // 清楚筛选
     m_toolBar->addAction("清除筛选", this, &MainWindow::onClearFilter);
 
     m_toolBar->addSeparator();
+
+    // 性能跟踪：勾选开始记录，取消时导出 Chrome 跟踪文件
+    QAction* traceAction = m_toolBar->addAction("性能跟踪");
+    traceAction->setCheckable(true);
+    traceAction->setChecked(PipelineTrace::isEnabled());
+    connect(traceAction, &QAction::toggled, this, &MainWindow::onToggleTrace);
 }
 
 void MainWindow::setupFormulaBar()
@@ -115,6 +141,9 @@ void MainWindow::setupTableView()
 
     m_mainLayout->addWidget(m_tableView);
 
+    m_refreshScheduler = new RealtimeRefreshScheduler(m_dataModel, this);
+    m_textIndex = new CellTextIndex(m_dataModel, this);
+
     connect(m_tableView->selectionModel(), &QItemSelectionModel::currentChanged,
         this, &MainWindow::onCurrentCellChanged);
     connect(m_dataModel, &ReportDataModel::cellChanged,
@@ -186,7 +215,7 @@ void MainWindow::onFillDownFormula()
     }
 
     // 2. 自动判断填充范围
-    int endRow = findFillEndRow(currentRow, currentCol);
+    int endRow = m_dataModel->findFillEndRow(currentRow, currentCol);
 
     if (endRow <= currentRow) {
         QMessageBox::information(this, "提示", "未找到可填充的范围（左侧列没有数据）");
@@ -205,78 +234,17 @@ void MainWindow::onFillDownFormula()
         return;
     }
 
-    // 4. 执行填充
-    QString originalFormula = sourceCell->formula;
-
-    for (int row = currentRow + 1; row <= endRow; row++) {
-        // 调整公式引用
-        QString adjustedFormula = adjustFormulaReferences(originalFormula, row - currentRow);
-
-        QModelIndex targetIndex = m_dataModel->index(row, currentCol);
-        m_dataModel->setData(targetIndex, adjustedFormula, Qt::EditRole);
+    // 4. 执行填充（模型层批量完成）
+    int filled = m_dataModel->fillDownFormula(currentRow, currentCol, endRow);
+    if (filled <= 0) {
+        QMessageBox::warning(this, "提示", "当前列不允许填充公式");
+        return;
     }
 
     QMessageBox::information(this, "完成",
         QString("已将公式填充到第 %1 行").arg(endRow + 1));
 }
 
-int MainWindow::findFillEndRow(int currentRow, int currentCol)
-{
-    int maxRow = currentRow;
-    int totalCols = m_dataModel->columnCount();
-
-    // 向左查找相邻的列，找到最后一个有数据的行
-    for (int col = 0; col < currentCol; col++) {
-        // 从当前行开始向下查找，找到该列最后一个非空单元格
-        for (int row = currentRow + 1; row < m_dataModel->rowCount(); row++) {
-            QModelIndex index = m_dataModel->index(row, col);
-            QVariant data = m_dataModel->data(index, Qt::DisplayRole);
-
-            if (!data.isNull() && !data.toString().trimmed().isEmpty()) {
-                maxRow = qMax(maxRow, row);
-            }
-        }
-    }
-
-    return maxRow;
-}
-
-// 工具函数：调整公式中的行引用
-QString MainWindow::adjustFormulaReferences(const QString& formula, int rowOffset)
-{
-    QString result = formula;
-
-    // 匹配单元格引用：支持 $A$1, $A1, A$1, A1
-    QRegularExpression regex(R"((\$?)([A-Z]+)(\$?)(\d+))");
-    QRegularExpressionMatchIterator it = regex.globalMatch(formula);
-
-    QList<QRegularExpressionMatch> matches;
-    while (it.hasNext()) {
-        matches.append(it.next());
-    }
-
-    // 从后往前替换
-    for (int i = matches.size() - 1; i >= 0; --i) {
-        const QRegularExpressionMatch& match = matches[i];
-        QString colAbs = match.captured(1);      // $ 或空
-        QString colPart = match.captured(2);     // A-Z
-        QString rowAbs = match.captured(3);      // $ 或空
-        QString rowPart = match.captured(4);     // 数字
-
-        int originalRow = rowPart.toInt();
-
-        // ✅ 只有非绝对引用才调整
-        int newRow = rowAbs.isEmpty() ? (originalRow + rowOffset) : originalRow;
-
-        QString newCellRef = colAbs + colPart + rowAbs + QString::number(newRow);
-
-        result.replace(match.capturedStart(), match.capturedLength(), newCellRef);
-    }
-
-    return result;
-}
-
-
 void MainWindow::updateTableSpans()
 {
     const auto& allCells = m_dataModel->getAllCells();
@@ -316,6 +284,10 @@ void MainWindow::onImportExcel()
     QFileInfo fileInfo(fileName);
     QString baseFileName = fileInfo.fileName();
 
+    // 切换文件前停止自动刷新和订阅
+    m_autoRefreshAction->setChecked(false);
+    m_subscribeAction->setChecked(false);
+
     if (baseFileName.startsWith("#REPO_")) {
         // ========== 历史报表模式 ==========
         m_dataModel->setWorkMode(ReportDataModel::HISTORY_MODE);
@@ -425,45 +397,31 @@ void MainWindow::onFindNext()
         return;
     }
 
-    // 从当前位置开始查找
-    QModelIndex startIndex = m_currentIndex.isValid() ? m_currentIndex : m_dataModel->index(0, 0);
-    int startRow = startIndex.row();
-    int startCol = startIndex.column();
-
-    // 从下一个单元格开始搜索
-    bool found = false;
-    for (int row = startRow; row < m_dataModel->rowCount() && !found; ++row) {
-        int beginCol = (row == startRow) ? startCol + 1 : 0;
-        for (int col = beginCol; col < m_dataModel->columnCount() && !found; ++col) {
-            QModelIndex index = m_dataModel->index(row, col);
-            QString cellText = m_dataModel->data(index, Qt::DisplayRole).toString();
-
-            if (cellText.contains(searchText, Qt::CaseInsensitive)) {
-                m_tableView->setCurrentIndex(index);
-                m_tableView->scrollTo(index);
-                found = true;
-            }
-        }
+    // 当前位置换算到源模型坐标（筛选时视图显示的是代理模型）
+    QModelIndex startIndex = m_currentIndex;
+    if (m_filterModel && startIndex.model() == m_filterModel) {
+        startIndex = m_filterModel->mapToSource(startIndex);
     }
+    int startRow = startIndex.isValid() ? startIndex.row() : 0;
+    int startCol = startIndex.isValid() ? startIndex.column() : -1;
 
-    if (!found) {
-        // 从头开始搜索到当前位置
-        for (int row = 0; row <= startRow && !found; ++row) {
-            int endCol = (row == startRow) ? startCol : m_dataModel->columnCount() - 1;
-            for (int col = 0; col <= endCol && !found; ++col) {
-                QModelIndex index = m_dataModel->index(row, col);
-                QString cellText = m_dataModel->data(index, Qt::DisplayRole).toString();
+    // 通过文本索引定位，按行优先顺序取当前位置之后的第一个可见匹配
+    const QVector<QPoint>& matches = m_textIndex->findCells(searchText);
+    QModelIndex found;
+    QPoint pos = m_textIndex->findNext(searchText, startRow, startCol);
+    for (int i = 0; i < matches.size() && pos.x() >= 0; ++i) {
+        QModelIndex sourceIndex = m_dataModel->index(pos.x(), pos.y());
+        found = m_filterModel ? m_filterModel->mapFromSource(sourceIndex) : sourceIndex;
+        if (found.isValid()) break;
 
-                if (cellText.contains(searchText, Qt::CaseInsensitive)) {
-                    m_tableView->setCurrentIndex(index);
-                    m_tableView->scrollTo(index);
-                    found = true;
-                }
-            }
-        }
+        // 被筛选隐藏的单元格跳过
+        pos = m_textIndex->findNext(searchText, pos.x(), pos.y());
     }
 
-    if (!found) {
+    if (found.isValid()) {
+        m_tableView->setCurrentIndex(found);
+        m_tableView->scrollTo(found);
+    } else {
         QMessageBox::information(this, "查找", "未找到匹配的内容");
     }
 }
@@ -475,22 +433,78 @@ void MainWindow::onFilter()
         "请输入筛选条件（支持通配符*和?）:", QLineEdit::Normal, "", &ok);
 
     if (ok && !filterText.isEmpty()) {
-        if (!m_filterModel) {
-            m_filterModel = new QSortFilterProxyModel(this);
-            m_filterModel->setSourceModel(m_dataModel);
-            m_filterModel->setFilterKeyColumn(-1); // 搜索所有列
-            m_tableView->setModel(m_filterModel);
-        }
+        // 由文本索引直接给出匹配行
+        applyRowFilter(m_textIndex->matchingRows(filterText, true));
+
+        //statusBar()->showMessage(QString("筛选结果：%1 行").arg(m_filterModel->rowCount()), 3000);
+    }
+}
 
-        // 转换通配符为正则表达式
-        QString regexPattern = QRegularExpression::escape(filterText);
-        regexPattern.replace("\\*", ".*");
-        regexPattern.replace("\\?", ".");
+void MainWindow::onNumericFilter()
+{
+    if (!m_dataModel->isHistoryMode() || !m_dataModel->hasHistoryData()) {
+        QMessageBox::information(this, "数值筛选", "数值筛选仅适用于已生成的历史报表");
+        return;
+    }
 
-        m_filterModel->setFilterRegularExpression(QRegularExpression(regexPattern, QRegularExpression::CaseInsensitiveOption));
+    QStringList columnNames;
+    for (const ReportColumnConfig& column : m_dataModel->getHistoryConfig().columns) {
+        columnNames.append(column.displayName);
+    }
 
-        //statusBar()->showMessage(QString("筛选结果：%1 行").arg(m_filterModel->rowCount()), 3000);
+    NumericFilterDialog dialog(columnNames, this);
+    if (dialog.exec() != QDialog::Accepted) {
+        return;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+
+    SelectionBitmap selection = HistoryFilterEngine::evaluate(m_dataModel, dialog.predicates(), dialog.combine());
+    applyRowFilter(selection.modelRows(true));
+
+    qDebug() << "数值筛选：" << selection.count() << "/" << selection.size() << "行，耗时" << timer.elapsed() << "ms";
+}
+
+void MainWindow::applyRowFilter(const QVector<int>& rows)
+{
+    if (!m_filterModel) {
+        m_filterModel = new RowIndexProxyModel(this);
+        m_filterModel->setSourceModel(m_dataModel);
+        m_tableView->setModel(m_filterModel);
+    }
+    m_filterModel->setRows(rows);
+}
+
+void MainWindow::onSortAscending()
+{
+    sortByCurrentColumn(Qt::AscendingOrder);
+}
+
+void MainWindow::onSortDescending()
+{
+    sortByCurrentColumn(Qt::DescendingOrder);
+}
+
+// 按当前列排序历史报表；已筛选时只对筛选结果排序
+void MainWindow::sortByCurrentColumn(Qt::SortOrder order)
+{
+    if (!m_dataModel->isHistoryMode() || !m_dataModel->hasHistoryData()) {
+        QMessageBox::information(this, "排序", "排序仅适用于已生成的历史报表");
+        return;
+    }
+
+    QModelIndex current = m_tableView->currentIndex();
+    int column = current.isValid() ? current.column() : 0;
+
+    QVector<int> rows = HistorySortEngine::sortedRows(m_dataModel, column, order,
+        m_filterModel ? m_filterModel->rows() : QVector<int>());
+    if (rows.isEmpty()) {
+        QMessageBox::information(this, "排序", "只能按时间列或数据列排序");
+        return;
     }
+
+    applyRowFilter(rows);
 }
 
 void MainWindow::onClearFilter()
@@ -728,8 +742,8 @@ void MainWindow::onRefreshData()
             return;
         }
 
-        m_dataModel->resolveDataBindings();
-        QMessageBox::information(this, "完成", "实时数据已更新！");
+        // 异步查询，结果返回后模型自行刷新界面
+        m_dataModel->requestDataBindingsAsync();
 
     }
     else if (mode == ReportDataModel::HISTORY_MODE) {
@@ -765,36 +779,107 @@ void MainWindow::onRefreshData()
     }
 }
 
-void MainWindow::refreshHistoryReport()
+void MainWindow::onToggleAutoRefresh(bool checked)
 {
-    HistoryReportConfig config = m_dataModel->getHistoryConfig();
-    const TimeRangeConfig& timeRange = m_globalConfig.globalTimeRange;
+    if (!checked) {
+        if (m_refreshScheduler->isRunning()) {
+            m_refreshScheduler->stop();
 
-    //  0. 过滤掉空配置行
-    QVector<ReportColumnConfig> validColumns;
-    for (const auto& col : config.columns) {
-        if (!col.displayName.trimmed().isEmpty() && !col.rtuId.trimmed().isEmpty()) {
-            validColumns.append(col);
+            const RealtimeRefreshScheduler::Stats& stats = m_refreshScheduler->stats();
+            qDebug() << "自动刷新已停止：刷新" << stats.ticks << "次，跳过" << stats.skippedBusy
+                << "次，超时" << stats.overruns << "次，最大耗时" << stats.maxDurationMs << "ms，最慢分块"
+                << stats.maxChunkMs << "ms";
         }
+        return;
+    }
+
+    if (m_dataModel->currentMode() != ReportDataModel::REALTIME_MODE || !m_dataModel->hasDataBindings()) {
+        QMessageBox::information(this, "提示", "自动刷新仅适用于包含 ## 数据绑定的实时报表。");
+        m_autoRefreshAction->setChecked(false);
+        return;
+    }
+
+    bool ok = false;
+    int seconds = QInputDialog::getInt(this, "自动刷新",
+        "刷新周期（秒）:", m_refreshScheduler->period() / 1000, 1, 60, 1, &ok);
+    if (!ok) {
+        m_autoRefreshAction->setChecked(false);
+        return;
+    }
+
+    // 周期刷新与订阅互斥
+    m_subscribeAction->setChecked(false);
+
+    m_refreshScheduler->setPeriod(seconds * 1000);
+    m_refreshScheduler->resetStats();
+    m_refreshScheduler->start();
+}
+
+void MainWindow::onToggleSubscription(bool checked)
+{
+    if (!checked) {
+        m_dataModel->stopBindingSubscription();
+        return;
     }
 
-    if (validColumns.isEmpty()) {
-        QMessageBox::warning(this, "错误", "配置中没有有效的列（名称和RTU号不能为空）");
+    if (m_dataModel->currentMode() != ReportDataModel::REALTIME_MODE || !m_dataModel->hasDataBindings()) {
+        QMessageBox::information(this, "提示", "订阅刷新仅适用于包含 ## 数据绑定的实时报表。");
+        m_subscribeAction->setChecked(false);
         return;
     }
 
-    config.columns = validColumns;  // 使用过滤后的配置
+    m_autoRefreshAction->setChecked(false);
 
-    // 1. 生成时间轴
-    QVector<QDateTime> timeAxis = ReportDataModel::generateTimeAxis(timeRange);
-    int totalPoints = timeAxis.size();
-    int totalColumns = config.columns.size();
+    // 设置 SCADA_RTDB_SIMULATE=1 时使用进程内模拟数据
+    UniversalQueryEngine::SubscriptionSource source = qEnvironmentVariableIntValue("SCADA_RTDB_SIMULATE") != 0
+        ? UniversalQueryEngine::SimulatedPublisher
+        : UniversalQueryEngine::RtdbPolling;
 
-    if (totalPoints == 0) {
-        QMessageBox::warning(this, "错误", "时间范围配置错误，无法生成时间轴。");
+    if (!m_dataModel->startBindingSubscription(source, m_refreshScheduler->period())) {
+        m_subscribeAction->setChecked(false);
+    }
+}
+
+void MainWindow::onToggleTrace(bool checked)
+{
+    if (checked) {
+        PipelineTrace::clear();
+        PipelineTrace::setEnabled(true);
         return;
     }
 
+    PipelineTrace::setEnabled(false);
+    if (PipelineTrace::eventCount() == 0) {
+        return;
+    }
+
+    QString fileName = QFileDialog::getSaveFileName(this, "导出性能跟踪",
+        QString("trace_%1.json").arg(QDateTime::currentDateTime().toString("yyyyMMdd_HHmmss")),
+        "Chrome 跟踪文件 (*.json)");
+    if (fileName.isEmpty()) {
+        return;
+    }
+
+    QString error;
+    if (!PipelineTrace::writeChromeTrace(fileName, &error)) {
+        QMessageBox::warning(this, "错误", QString("跟踪文件写入失败：%1").arg(error));
+    }
+}
+
+void MainWindow::refreshHistoryReport()
+{
+    const TimeRangeConfig& timeRange = m_globalConfig.globalTimeRange;
+
+    // 1. 过滤空配置行、生成时间轴
+    HistoryReportPipeline pipeline(m_dataModel);
+    if (!pipeline.prepare(timeRange)) {
+        QMessageBox::warning(this, "错误", pipeline.errorString());
+        return;
+    }
+
+    int totalPoints = pipeline.pointCount();
+    int totalColumns = pipeline.columnCount();
+
     // 2. 数据量预警
     if (totalPoints > 50000) {
         auto reply = QMessageBox::question(this, "数据量警告",
@@ -825,66 +910,36 @@ void MainWindow::refreshHistoryReport()
     progress.show();
     qApp->processEvents();
 
-    // 4. 批量查询所有RTU
-    TaosDataFetcher fetcher;
-    QHash<QString, std::map<int64_t, std::vector<float>>> rawData;
-    QStringList failedRTUs;
+    // 4. 查询 → 对齐 → 生成表格
+    // 跟踪区间只包含流水线本身，不计入之后提示框的等待时间
+    bool ok = false;
+    {
+        TRACE_SCOPE_ARG("ui.refreshHistoryReport", totalPoints);
+        ok = pipeline.execute([&progress](int percent) {
+            progress.setValue(percent);
+            qApp->processEvents();
+            return !progress.wasCanceled();
+        });
+    }
 
-    for (int i = 0; i < totalColumns; i++) {
-        if (progress.wasCanceled()) {
+    if (!ok) {
+        if (pipeline.wasCanceled()) {
             QMessageBox::information(this, "已取消", "数据查询已取消。");
-            return;
         }
-
-        const ReportColumnConfig& col = config.columns[i];
-
-        // 构造查询地址
-        QString address = QString("%1@%2~%3#%4")
-            .arg(col.rtuId)
-            .arg(timeRange.startTime.toString("yyyy-MM-dd HH:mm:ss"))
-            .arg(timeRange.endTime.toString("yyyy-MM-dd HH:mm:ss"))
-            .arg(timeRange.intervalSeconds);
-
-        try {
-            auto data = fetcher.fetchDataFromAddress(address.toStdString());
-
-            if (data.empty()) {
-                qWarning() << "RTU无数据:" << col.rtuId;
-                failedRTUs.append(QString("%1 (无数据)").arg(col.displayName));
-                rawData[col.rtuId] = {};
-            }
-            else {
-                rawData[col.rtuId] = data;
-            }
-
-        }
-        catch (const std::exception& e) {
-            qWarning() << "RTU查询失败:" << col.rtuId << e.what();
-            failedRTUs.append(QString("%1 (查询失败: %2)").arg(col.displayName).arg(e.what()));
-            rawData[col.rtuId] = {};
+        else {
+            QMessageBox::warning(this, "错误", pipeline.errorString());
         }
-
-        progress.setValue(10 + i * 70 / totalColumns);
-        qApp->processEvents();
+        return;
     }
 
-    // 5. 时间对齐（线性插值）
-    QHash<QString, QVector<double>> alignedData =
-        ReportDataModel::alignDataWithInterpolation(rawData, timeAxis);
-    progress.setValue(90);
-
-    // 6. 生成表格
-    m_dataModel->generateHistoryReport(config, alignedData, timeAxis);
-    progress.setValue(100);
-
-    // 7. 完成提示
+    // 5. 完成提示
     QString message = QString("报表生成完成：%1 行 × %2 列")
         .arg(totalPoints + 1)
         .arg(totalColumns + 1);
 
-    if (!failedRTUs.isEmpty()) {
+    if (!pipeline.failedColumns().isEmpty()) {
         message += QString("\n\n以下列查询失败或无数据：\n%1")
-            .arg(failedRTUs.join("\n"));
+            .arg(pipeline.failedColumns().join("\n"));
         QMessageBox::warning(this, "部分数据缺失", message);
     }
     else {
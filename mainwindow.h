@@ -12,12 +12,14 @@
 #include <QMenu>
 #include <QDialog>
 #include <QPushButton>
-#include <QSortFilterProxyModel>
 
 #include "TimeSettingsDialog.h"  // 新增
 #include "DataBindingConfig.h" 
 
 class ReportDataModel;
+class RealtimeRefreshScheduler;
+class CellTextIndex;
+class RowIndexProxyModel;
 
 class MainWindow : public QMainWindow
 {
@@ -36,6 +38,9 @@ private slots:
     void onFind();
     void onFindNext();
     void onFilter();
+    void onNumericFilter();
+    void onSortAscending();
+    void onSortDescending();
     void onClearFilter();
 
     void onCurrentCellChanged(const QModelIndex& current, const QModelIndex& previous);
@@ -51,6 +56,9 @@ private slots:
 
     void onRefreshData();  // 保留，但实现会改变
     void onRestoreConfig();
+    void onToggleAutoRefresh(bool checked);
+    void onToggleSubscription(bool checked);
+    void onToggleTrace(bool checked);
 
     void onFillDownFormula();
 
@@ -73,9 +81,9 @@ private:
 
     void refreshHistoryReport();
 
-    QString adjustFormulaReferences(const QString& formula, int rowOffset);
-
-    int findFillEndRow(int currentRow, int currentCol);
+    // 按源行号列表筛选显示
+    void applyRowFilter(const QVector<int>& rows);
+    void sortByCurrentColumn(Qt::SortOrder order);
 
 private:
     // UI组件
@@ -84,6 +92,11 @@ private:
 
     // 工具栏
     QToolBar* m_toolBar;
+    QAction* m_autoRefreshAction;
+    QAction* m_subscribeAction;
+
+    // 实时模式周期刷新
+    RealtimeRefreshScheduler* m_refreshScheduler;
 
     // 公式栏
     QWidget* m_formulaWidget;
@@ -93,7 +106,8 @@ private:
     // 表格
     QTableView* m_tableView;
     ReportDataModel* m_dataModel;
-    QSortFilterProxyModel* m_filterModel;
+    RowIndexProxyModel* m_filterModel;
+    CellTextIndex* m_textIndex;      // 查找/筛选用的单元格文本索引
 
     // 查找对话框
     QDialog* m_findDialog;
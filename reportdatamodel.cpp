@@ -2,6 +2,8 @@
 #include "formulaengine.h"
 #include "excelhandler.h" // 用于文件操作
 #include "UniversalQueryEngine.h"
+#include "RtdbSubscription.h"
+#include "PipelineTrace.h"
 // QXlsx相关（检查是否已包含）
 #include "xlsxdocument.h"      // 用于 QXlsx::Document
 #include "xlsxcellrange.h"     // 用于 QXlsx::CellRange
@@ -21,6 +23,7 @@
 #include <QDebug>              // 用于 qDebug
 #include <limits>              // 用于 std::numeric_limits
 #include <cmath>               // 用于 std::isnan, std::isinf
+#include <algorithm>           // 用于 std::sort, std::unique
 #include <QMessageBox>
 
 
@@ -30,11 +33,31 @@ ReportDataModel::ReportDataModel(QObject* parent)
     , m_maxRow(100) // 默认初始行数
     , m_maxCol(26)  // 默认初始列数 (A-Z)
     , m_formulaEngine(new FormulaEngine(this))
+    , m_bindingRefreshActive(false)
+    , m_bindingPlanDirty(true)
+    , m_formulaCellCount(0)
+    , m_formulaDepsDirty(true)
+    , m_queryEngine(new UniversalQueryEngine())
+    , m_queryWorker(new RtdbQueryWorker(m_queryEngine.get()))
+    , m_latestRequestId(0)
+    , m_pendingRequestId(0)
+    , m_pendingSince(0)
+    , m_subscription(nullptr)
 {
+    // RTDB 查询线程：工作对象随线程退出销毁
+    m_queryWorker->moveToThread(&m_queryThread);
+    connect(&m_queryThread, &QThread::finished, m_queryWorker, &QObject::deleteLater);
+    connect(this, &ReportDataModel::bindingQueryRequested,
+        m_queryWorker, &RtdbQueryWorker::runQuery, Qt::QueuedConnection);
+    connect(m_queryWorker, &RtdbQueryWorker::queryFinished,
+        this, &ReportDataModel::onBindingQueryFinished, Qt::QueuedConnection);
+    m_queryThread.start();
 }
 
 ReportDataModel::~ReportDataModel()
 {
+    m_queryThread.quit();
+    m_queryThread.wait();
     qDeleteAll(m_cells);
 }
 
@@ -109,6 +132,67 @@ QFont ReportDataModel::ensureFontAvailable(const QFont& requestedFont) const
     return font;
 }
 
+uint qHash(const ReportDataModel::FontCacheKey& key, uint seed)
+{
+    return qHash(key.family, seed) ^ qHash(key.pointSize, seed) ^ (static_cast<uint>(key.pixelSize) << 16) ^
+        (static_cast<uint>(key.weight) << 4) ^ (key.italic ? 1u : 0u) ^ (key.underline ? 2u : 0u) ^
+        (key.strikeOut ? 8u : 0u);
+}
+
+// 按字体属性缓存 ensureFontAvailable 的结果，避免每次 FontRole 都构造 QFontInfo
+QFont ReportDataModel::cachedFont(const QFont& requestedFont) const
+{
+    FontCacheKey key;
+    key.family = requestedFont.family();
+    key.pointSize = requestedFont.pointSizeF();
+    key.pixelSize = requestedFont.pixelSize();
+    key.weight = requestedFont.weight();
+    key.italic = requestedFont.italic();
+    key.underline = requestedFont.underline();
+    key.strikeOut = requestedFont.strikeOut();
+
+    auto it = m_fontCache.constFind(key);
+    if (it != m_fontCache.constEnd()) {
+        ++m_styleCacheStats.fontHits;
+        return it.value();
+    }
+
+    ++m_styleCacheStats.fontMisses;
+    QFont font = ensureFontAvailable(requestedFont);
+    m_fontCache.insert(key, font);
+    return font;
+}
+
+QBrush ReportDataModel::cachedBrush(const QColor& color) const
+{
+    const QRgb key = color.rgba();
+    auto it = m_brushCache.constFind(key);
+    if (it != m_brushCache.constEnd()) {
+        ++m_styleCacheStats.brushHits;
+        return it.value();
+    }
+
+    ++m_styleCacheStats.brushMisses;
+    QBrush brush(color);
+    m_brushCache.insert(key, brush);
+    return brush;
+}
+
+ReportDataModel::StyleCacheStats ReportDataModel::styleCacheStats() const
+{
+    StyleCacheStats stats = m_styleCacheStats;
+    stats.fontEntries = m_fontCache.size();
+    stats.brushEntries = m_brushCache.size();
+    return stats;
+}
+
+void ReportDataModel::clearStyleCaches()
+{
+    m_fontCache.clear();
+    m_brushCache.clear();
+    m_styleCacheStats = StyleCacheStats();
+}
+
 QVariant ReportDataModel::data(const QModelIndex& index, int role) const
 {
     if (!index.isValid())
@@ -140,13 +224,11 @@ QVariant ReportDataModel::getRealtimeCellData(const QModelIndex& index, int role
         case Qt::EditRole:
             return isMainCell ? cell->value.toString() : QVariant();
         case Qt::BackgroundRole:
-            return QBrush(cell->style.backgroundColor);
+            return cachedBrush(cell->style.backgroundColor);
         case Qt::ForegroundRole:
-            return QBrush(cell->style.textColor);
-        case Qt::FontRole: {
-            QFont font = ensureFontAvailable(cell->style.font);
-            return font;
-        }
+            return cachedBrush(cell->style.textColor);
+        case Qt::FontRole:
+            return cachedFont(cell->style.font);
         case Qt::TextAlignmentRole:
             return static_cast<int>(cell->style.alignment);
         default:
@@ -156,18 +238,22 @@ QVariant ReportDataModel::getRealtimeCellData(const QModelIndex& index, int role
 
     // 普通单元格处理
     switch (role) {
+    case SparklineRole: {
+        if (!cell->isDataBinding) return QVariant();
+        int keyIndex = m_bindingPlan.keyIndex.value(cell->bindingKey, -1);
+        if (keyIndex < 0 || keyIndex >= m_trendHistory.size()) return QVariant();
+        return QVariant::fromValue(m_trendHistory[keyIndex]);
+    }
     case Qt::DisplayRole:
         return cell->displayText();
     case Qt::EditRole:
         return cell->editText();
     case Qt::BackgroundRole:
-        return QBrush(cell->style.backgroundColor);
+        return cachedBrush(cell->style.backgroundColor);
     case Qt::ForegroundRole:
-        return QBrush(cell->style.textColor);
-    case Qt::FontRole: {
-        QFont font = ensureFontAvailable(cell->style.font);
-        return font;
-    }
+        return cachedBrush(cell->style.textColor);
+    case Qt::FontRole:
+        return cachedFont(cell->style.font);
     case Qt::TextAlignmentRole:
         return static_cast<int>(cell->style.alignment);
     default:
@@ -192,7 +278,7 @@ QVariant ReportDataModel::getHistoryReportCellData(const QModelIndex& index, int
         }
 
         if (role == Qt::BackgroundRole) {
-            return QBrush(QColor(250, 250, 250));
+            return cachedBrush(QColor(250, 250, 250));
         }
 
         if (role == Qt::TextAlignmentRole) {
@@ -212,6 +298,11 @@ QVariant ReportDataModel::getHistoryReportCellData(const QModelIndex& index, int
                 return QVariant();
             }
 
+            // 公式列中用户输入的内容
+            if (const CellData* cell = getCell(row, col)) {
+                return role == Qt::EditRole ? cell->editText() : cell->displayText();
+            }
+
             // 数据行
             int dataRow = row - 1;
             if (dataRow >= 0 && dataRow < m_fullTimeAxis.size()) {
@@ -243,10 +334,10 @@ QVariant ReportDataModel::getHistoryReportCellData(const QModelIndex& index, int
 
         if (role == Qt::BackgroundRole) {
             if (row == 0) {
-                return QBrush(QColor(220, 220, 220)); // 表头灰色
+                return cachedBrush(QColor(220, 220, 220)); // 表头灰色
             }
             else {
-                return (row % 2 == 0) ? QBrush(Qt::white) : QBrush(QColor(248, 248, 248)); // 斑马纹
+                return (row % 2 == 0) ? cachedBrush(Qt::white) : cachedBrush(QColor(248, 248, 248)); // 斑马纹
             }
         }
 
@@ -267,9 +358,12 @@ void ReportDataModel::setWorkMode(WorkMode mode)
         // 切换模式时清理对方模式的数据
         if (mode == HISTORY_MODE) {
             // 切换到报表模式，清理实时模式数据
+            stopBindingSubscription();
             if (!m_cells.isEmpty()) {
                 qDeleteAll(m_cells);
                 m_cells.clear();
+                invalidateBindingPlan();
+                invalidateFormulaDependencies();
                 qDebug() << "已清理实时模式数据";
             }
         }
@@ -277,6 +371,7 @@ void ReportDataModel::setWorkMode(WorkMode mode)
             // 切换到实时模式，清理报表数据
             if (!m_fullTimeAxis.isEmpty() || !m_fullAlignedData.isEmpty()) {
                 m_fullTimeAxis.clear();
+                m_timeAxisSecs.clear();
                 m_fullAlignedData.clear();
                 m_historyConfig.columns.clear();
                 m_historyConfig.reportName.clear();
@@ -376,6 +471,7 @@ void ReportDataModel::displayConfigFileContent()
 
     clearAllCells();
     m_fullTimeAxis.clear();
+    m_timeAxisSecs.clear();
     m_fullAlignedData.clear();
 
     int rowCount = m_historyConfig.columns.size();
@@ -390,17 +486,26 @@ void ReportDataModel::generateHistoryReport(
     const QHash<QString, QVector<double>>& alignedData,
     const QVector<QDateTime>& timeAxis)
 {
+    TRACE_SCOPE_ARG("model.historyReset", timeAxis.size());
     beginResetModel();
 
     if (!m_cells.isEmpty()) {
         qDeleteAll(m_cells);
         m_cells.clear();
+        invalidateBindingPlan();
+        invalidateFormulaDependencies();
     }
 
     m_historyConfig = config;
     m_fullTimeAxis = timeAxis;
     m_fullAlignedData = alignedData;
 
+    // 时间轴的秒值缓存，供公式引擎的时序函数直接扫描
+    m_timeAxisSecs.resize(timeAxis.size());
+    for (int i = 0; i < timeAxis.size(); ++i) {
+        m_timeAxisSecs[i] = timeAxis[i].toSecsSinceEpoch();
+    }
+
     // 记录数据列的索引（时间列 + 所有RTU数据列）
     m_historyConfig.dataColumns.clear();
     m_historyConfig.dataColumns.insert(0);  // 时间列
@@ -417,6 +522,22 @@ void ReportDataModel::generateHistoryReport(
     qDebug() << "报表已生成，数据列索引：" << m_historyConfig.dataColumns;
 }
 
+void ReportDataModel::setHistoryColumnData(const QString& rtuId, const QVector<double>& values)
+{
+    if (m_fullTimeAxis.isEmpty()) return;
+
+    TRACE_SCOPE("model.publishColumn");
+    m_fullAlignedData.insert(rtuId, values);
+
+    // 同一 RTU 可能配置在多列
+    const int lastRow = m_fullTimeAxis.size();
+    for (int i = 0; i < m_historyConfig.columns.size(); ++i) {
+        if (m_historyConfig.columns[i].rtuId == rtuId) {
+            emit dataChanged(index(1, i + 1), index(lastRow, i + 1), { Qt::DisplayRole, Qt::EditRole });
+        }
+    }
+}
+
 //  生成时间轴（静态函数）
 QVector<QDateTime> ReportDataModel::generateTimeAxis(const TimeRangeConfig& config)
 {
@@ -449,70 +570,77 @@ QHash<QString, QVector<double>> ReportDataModel::alignDataWithInterpolation(
 {
     QHash<QString, QVector<double>> result;
 
+    QVector<qint64> timeAxisSecs(timeAxis.size());
+    for (int i = 0; i < timeAxis.size(); ++i) {
+        timeAxisSecs[i] = timeAxis[i].toSecsSinceEpoch();  //  直接用秒
+    }
+
     for (auto it = rawData.constBegin(); it != rawData.constEnd(); ++it) {
-        QString rtuId = it.key();
-        const std::map<int64_t, std::vector<float>>& dataMap = it.value();
+        result[it.key()] = alignSeriesWithInterpolation(it.value(), timeAxisSecs);
+    }
 
-        QVector<double> alignedValues;
-        alignedValues.reserve(timeAxis.size());
+    return result;
+}
+
+QVector<double> ReportDataModel::alignSeriesWithInterpolation(
+    const std::map<int64_t, std::vector<float>>& dataMap,
+    const QVector<qint64>& timeAxisSecs)
+{
+    QVector<double> alignedValues;
+    alignedValues.reserve(timeAxisSecs.size());
 
-        if (dataMap.empty()) {
-            alignedValues.fill(std::numeric_limits<double>::quiet_NaN(), timeAxis.size());
-            result[rtuId] = alignedValues;
+    if (dataMap.empty()) {
+        alignedValues.fill(std::numeric_limits<double>::quiet_NaN(), timeAxisSecs.size());
+        return alignedValues;
+    }
+
+    for (qint64 targetTs : timeAxisSecs) {
+        auto upper = dataMap.lower_bound(targetTs);
+
+        //  判断是否完美匹配
+        if (upper != dataMap.end() && upper->first == targetTs) {
+            // 完美匹配，直接使用值，无需插值
+            alignedValues.append(static_cast<double>(upper->second[0]));
             continue;
         }
 
-        for (const QDateTime& targetTime : timeAxis) {
-            qint64 targetTs = targetTime.toSecsSinceEpoch();  //  直接用秒
-
-            auto upper = dataMap.lower_bound(targetTs);
+        // 以下是原有的插值逻辑
+        if (upper == dataMap.end()) {
+            float lastValue = dataMap.rbegin()->second[0];
+            alignedValues.append(static_cast<double>(lastValue));
+        }
+        else if (upper == dataMap.begin()) {
+            float firstValue = upper->second[0];
+            alignedValues.append(static_cast<double>(firstValue));
+        }
+        else {
+            qint64 t2 = upper->first;
+            float v2 = upper->second[0];
 
-            //  判断是否完美匹配
-            if (upper != dataMap.end() && upper->first == targetTs) {
-                // 完美匹配，直接使用值，无需插值
-                alignedValues.append(static_cast<double>(upper->second[0]));
-                continue;
-            }
+            auto lower = std::prev(upper);
+            qint64 t1 = lower->first;
+            float v1 = lower->second[0];
 
-            // 以下是原有的插值逻辑
-            if (upper == dataMap.end()) {
-                float lastValue = dataMap.rbegin()->second[0];
-                alignedValues.append(static_cast<double>(lastValue));
-            }
-            else if (upper == dataMap.begin()) {
-                float firstValue = upper->second[0];
-                alignedValues.append(static_cast<double>(firstValue));
+            if (t2 == t1) {
+                alignedValues.append(static_cast<double>(v1));
             }
             else {
-                qint64 t2 = upper->first;
-                float v2 = upper->second[0];
-
-                auto lower = std::prev(upper);
-                qint64 t1 = lower->first;
-                float v1 = lower->second[0];
-
-                if (t2 == t1) {
-                    alignedValues.append(static_cast<double>(v1));
-                }
-                else {
-                    // 线性插值
-                    double ratio = static_cast<double>(targetTs - t1) / (t2 - t1);
-                    double interpolated = v1 + (v2 - v1) * ratio;
-                    alignedValues.append(interpolated);
-                }
+                // 线性插值
+                double ratio = static_cast<double>(targetTs - t1) / (t2 - t1);
+                double interpolated = v1 + (v2 - v1) * ratio;
+                alignedValues.append(interpolated);
             }
         }
-
-        result[rtuId] = alignedValues;
     }
 
-    return result;
+    return alignedValues;
 }
 
 bool ReportDataModel::exportHistoryReportToExcel(
     const QString& fileName,
     QProgressDialog* progress)
 {
+    TRACE_SCOPE("export.historyExcel");
     if (!hasHistoryData()) {
         qWarning() << "没有可导出的报表数据";
         return false;
@@ -676,6 +804,7 @@ bool ReportDataModel::setData(const QModelIndex& index, const QVariant& value, i
 
             QString text = value.toString();
 
+            invalidateFormulaDependencies();
             if (text.startsWith('=')) {
                 cell->setFormula(text);
                 calculateFormula(index.row(), index.column());
@@ -695,14 +824,22 @@ bool ReportDataModel::setData(const QModelIndex& index, const QVariant& value, i
 
     QString text = value.toString();
 
-    if (text.startsWith('##'))
+    // 新增或覆盖绑定单元格时重新编译绑定计划
+    if (cell->isDataBinding || text.startsWith("##")) {
+        invalidateBindingPlan();
+    }
+    if (cell->hasFormula || text.startsWith('=')) {
+        invalidateFormulaDependencies();
+    }
+
+    if (text.startsWith("##"))
     {
         cell->isDataBinding = true;
         cell->bindingKey = text;
         cell->hasFormula = false;
         cell->formula.clear();
         cell->value = "0";
-        resolveDataBindings();
+        requestDataBindingsAsync();
     }
     else if (text.startsWith('=')) {
         cell->isDataBinding = false;
@@ -719,6 +856,13 @@ bool ReportDataModel::setData(const QModelIndex& index, const QVariant& value, i
     }
 
     emit dataChanged(index, index, { role });
+
+    // 引用本单元格的公式随之重算
+    QVector<QPoint> changedCells{ QPoint(index.row(), index.column()) };
+    recalculateDependents(changedCells);
+    changedCells.removeFirst();
+    emitCellsChanged(changedCells);
+
     emit cellChanged(index.row(), index.column());
     return true;
 }
@@ -823,6 +967,8 @@ bool ReportDataModel::insertRows(int row, int count, const QModelIndex& parent)
     }
     m_cells = newCells;
     m_maxRow += count;
+    invalidateBindingPlan();
+    invalidateFormulaDependencies();
 
     endInsertRows();
     return true;
@@ -880,6 +1026,8 @@ bool ReportDataModel::removeRows(int row, int count, const QModelIndex& parent)
     }
     m_cells = newCells;
     m_maxRow -= count;
+    invalidateBindingPlan();
+    invalidateFormulaDependencies();
 
     endRemoveRows();
     return true;
@@ -921,6 +1069,8 @@ bool ReportDataModel::insertColumns(int column, int count, const QModelIndex& pa
     }
     m_cells = newCells;
     m_maxCol += count;
+    invalidateBindingPlan();
+    invalidateFormulaDependencies();
 
     endInsertColumns();
     return true;
@@ -976,6 +1126,8 @@ bool ReportDataModel::removeColumns(int column, int count, const QModelIndex& pa
     }
     m_cells = newCells;
     m_maxCol -= count;
+    invalidateBindingPlan();
+    invalidateFormulaDependencies();
 
     endRemoveColumns();
     return true;
@@ -1008,30 +1160,457 @@ bool ReportDataModel::loadFromExcel(const QString& fileName)
 // 并通过信号发送给外部（例如MainWindow）去查询数据。
 void ReportDataModel::resolveDataBindings()
 {
-    QList<QString> keysToResolve;
+    resolveDataBindings(QSet<QString>());
+}
+
+// 只刷新指定的绑定键（为空时刷新全部），供周期刷新调度器按等级调用
+void ReportDataModel::resolveDataBindings(const QSet<QString>& onlyKeys)
+{
+    TRACE_SCOPE_ARG("model.resolveBindings", onlyKeys.size());
+    UniversalQueryEngine::BatchHandle batch = batchForKeys(onlyKeys);
+    if (!batch) {
+        return;
+    }
+
+    m_bindingRefreshActive = true;
+    QVariantList values = m_queryEngine->executeBatch(batch);
+    m_bindingRefreshActive = false;
+
+    recordTrendSamples(batch, values, nullptr);
+    applyBindingResults(batch, values);
+}
+
+// 异步刷新：查询在工作线程执行，结果通过队列信号回到界面线程应用
+quint64 ReportDataModel::requestDataBindingsAsync(const QSet<QString>& onlyKeys)
+{
+    UniversalQueryEngine::BatchHandle batch = batchForKeys(onlyKeys);
+    if (!batch) {
+        return 0;
+    }
+
+    // 新请求取代尚未返回的旧请求
+    quint64 requestId = ++m_latestRequestId;
+    m_pendingRequestId = requestId;
+    m_pendingSince = QDateTime::currentMSecsSinceEpoch();
+    m_queryWorker->supersede(requestId);
+
+    emit bindingQueryRequested(requestId, batch, m_sampleSet);
+    return requestId;
+}
+
+void ReportDataModel::onBindingQueryFinished(quint64 requestId, const UniversalQueryEngine::BatchHandle& batch,
+    const QVariantList& values, qint64 elapsedMs, const UniversalQueryEngine::ChunkTimingList& chunkTimings)
+{
+    drainTrendSamples();
+
+    if (requestId != m_pendingRequestId) {
+        qDebug() << "丢弃过期的绑定查询结果:" << requestId;
+        return;
+    }
+    m_pendingRequestId = 0;
+
+    // 查询期间模式可能已切换
+    if (m_currentMode == REALTIME_MODE) {
+        applyBindingResults(batch, values);
+    }
+
+    qint64 roundTripMs = QDateTime::currentMSecsSinceEpoch() - m_pendingSince;
+    emit bindingRefreshFinished(roundTripMs, elapsedMs, chunkTimings);
+}
+
+void ReportDataModel::invalidateBindingPlan()
+{
+    m_bindingPlanDirty = true;
+}
+
+// 扫描一次 m_cells 编译绑定计划，之后的刷新不再遍历全部单元格
+const ReportDataModel::BindingPlan& ReportDataModel::bindingPlan()
+{
+    if (!m_bindingPlanDirty) {
+        return m_bindingPlan;
+    }
+
+    m_bindingPlan = BindingPlan();
+    m_subsetBatches.clear();
+
     for (auto it = m_cells.constBegin(); it != m_cells.constEnd(); ++it) {
         CellData* cell = it.value();
-        if (cell && cell->isDataBinding) {
-            keysToResolve.append(cell->bindingKey);
+        if (!cell || !cell->isDataBinding) continue;
+
+        int keyIndex = m_bindingPlan.keyIndex.value(cell->bindingKey, -1);
+        if (keyIndex < 0) {
+            keyIndex = m_bindingPlan.keys.size();
+            m_bindingPlan.keys.append(cell->bindingKey);
+            m_bindingPlan.keyIndex.insert(cell->bindingKey, keyIndex);
+            m_bindingPlan.cells.append(QVector<QPoint>());
+        }
+        m_bindingPlan.cells[keyIndex].append(it.key());
+    }
+
+    if (!m_bindingPlan.keys.isEmpty()) {
+        m_bindingPlan.batch = UniversalQueryEngine::compileBatch(m_bindingPlan.keys);
+    }
+
+    // 趋势缓冲区随计划重建，旧缓冲区由仍在途的请求持有至其结束
+    m_sampleSet = m_bindingPlan.batch
+        ? std::make_shared<BindingSampleSet>(m_bindingPlan.batch, kTrendCapacity)
+        : BindingSampleSetPtr();
+    m_trendHistory = QVector<QVector<QPointF>>(m_bindingPlan.keys.size());
+
+    m_bindingPlanDirty = false;
+    qDebug() << "绑定计划已编译：" << m_bindingPlan.keys.size() << "个唯一键";
+
+    // 订阅中的批次随计划更新
+    pushSubscriptionBatch();
+    return m_bindingPlan;
+}
+
+// 全量刷新直接使用计划中的批次；按等级的子集刷新缓存各自的子批次
+UniversalQueryEngine::BatchHandle ReportDataModel::batchForKeys(const QSet<QString>& onlyKeys)
+{
+    const BindingPlan& plan = bindingPlan();
+    if (onlyKeys.isEmpty() || !plan.batch) {
+        return plan.batch;
+    }
+
+    QStringList subset;
+    for (const QString& key : plan.keys) {
+        if (onlyKeys.contains(key)) {
+            subset.append(key);
+        }
+    }
+    if (subset.isEmpty()) {
+        return UniversalQueryEngine::BatchHandle();
+    }
+    if (subset.size() == plan.keys.size()) {
+        return plan.batch;
+    }
+
+    // plan.keys 顺序固定，拼接结果可作为子集的缓存键
+    const QString cacheKey = subset.join(QChar('\n'));
+    auto cached = m_subsetBatches.constFind(cacheKey);
+    if (cached != m_subsetBatches.constEnd()) {
+        return cached.value();
+    }
+
+    UniversalQueryEngine::BatchHandle batch = UniversalQueryEngine::compileBatch(subset);
+    m_subsetBatches.insert(cacheKey, batch);
+    return batch;
+}
+
+// 新值是否需要写入：类型变化总是更新，数值按死区比较
+static bool bindingValueChanged(const QVariant& oldValue, const QVariant& newValue, double deadband)
+{
+    if (oldValue.type() != newValue.type()) {
+        return true;
+    }
+
+    bool oldOk = false;
+    bool newOk = false;
+    double oldNumber = oldValue.toDouble(&oldOk);
+    double newNumber = newValue.toDouble(&newOk);
+    if (oldOk && newOk && oldValue.type() != QVariant::String) {
+        return deadband > 0.0 ? std::fabs(newNumber - oldNumber) > deadband : newNumber != oldNumber;
+    }
+    return oldValue != newValue;
+}
+
+// 通过反向索引只写入绑定单元格，值未变化的不重算也不通知
+void ReportDataModel::applyBindingResults(const UniversalQueryEngine::BatchHandle& batch, const QVariantList& values,
+    const QVector<int>* indexes)
+{
+    const BindingPlan& plan = bindingPlan();
+    const QStringList keys = UniversalQueryEngine::batchKeys(batch);
+    const bool samePlan = (batch == plan.batch);
+
+    QVector<QPoint> changedCells;
+    const int count = indexes ? qMin(indexes->size(), values.size()) : qMin(keys.size(), values.size());
+    for (int n = 0; n < count; ++n) {
+        const int i = indexes ? indexes->at(n) : n;
+        if (i < 0 || i >= keys.size()) continue;
+
+        // 结果来自旧计划或子批次时按键名映射
+        int keyIndex = samePlan ? i : plan.keyIndex.value(keys[i], -1);
+        if (keyIndex < 0) continue;
+
+        double deadband = m_bindingDeadbands.isEmpty() ? 0.0 : m_bindingDeadbands.value(keys[i], 0.0);
+
+        for (const QPoint& pos : plan.cells[keyIndex]) {
+            CellData* cell = m_cells.value(pos, nullptr);
+            if (cell && cell->isDataBinding && bindingValueChanged(cell->value, values[n], deadband)) {
+                cell->value = values[n];
+                changedCells.append(pos);
+            }
         }
     }
 
-    if (keysToResolve.isEmpty()) {
+    if (changedCells.isEmpty()) {
         return;
     }
 
-    QHash<QString, QVariant> resolvedData = UniversalQueryEngine::instance().queryValuesForBindingKeys(keysToResolve);
+    recalculateDependents(changedCells);
+    emitCellsChanged(changedCells);
+}
 
-    // 更新单元格的值
-    for (auto it = m_cells.begin(); it != m_cells.end(); ++it) {
-        CellData* cell = it.value();
-        if (cell && cell->isDataBinding && resolvedData.contains(cell->bindingKey)) {
-            cell->value = resolvedData[cell->bindingKey];
+bool ReportDataModel::startBindingSubscription(UniversalQueryEngine::SubscriptionSource source, int intervalMs)
+{
+    stopBindingSubscription();
+
+    if (m_currentMode != REALTIME_MODE || !bindingPlan().batch) {
+        return false;
+    }
+
+    m_subscription = m_queryEngine->createSubscription(source, intervalMs);
+    m_subscription->moveToThread(&m_queryThread);
+    connect(&m_queryThread, &QThread::finished, m_subscription, &QObject::deleteLater);
+    connect(m_subscription, &RtdbSubscription::valuesChanged,
+        this, &ReportDataModel::onSubscriptionValuesChanged, Qt::QueuedConnection);
+
+    pushSubscriptionBatch();
+    qDebug() << "绑定订阅已启动：" << m_bindingPlan.keys.size() << "个唯一键";
+    return true;
+}
+
+void ReportDataModel::stopBindingSubscription()
+{
+    if (!m_subscription) return;
+
+    RtdbSubscription* subscription = m_subscription;
+    m_subscription = nullptr;
+
+    // 在查询线程中退订并释放
+    QMetaObject::invokeMethod(subscription, [subscription]() {
+        subscription->unsubscribe();
+        subscription->deleteLater();
+    }, Qt::QueuedConnection);
+    qDebug() << "绑定订阅已停止";
+}
+
+void ReportDataModel::pushSubscriptionBatch()
+{
+    if (!m_subscription) return;
+
+    RtdbSubscription* subscription = m_subscription;
+    UniversalQueryEngine::BatchHandle batch = m_bindingPlan.batch;
+    QMetaObject::invokeMethod(subscription, [subscription, batch]() {
+        subscription->subscribe(batch);
+    }, Qt::QueuedConnection);
+}
+
+void ReportDataModel::onSubscriptionValuesChanged(const UniversalQueryEngine::BatchHandle& batch,
+    const QVector<int>& indexes, const QVariantList& values)
+{
+    // 停止后仍在队列中的通知直接丢弃
+    if (!m_subscription || sender() != m_subscription || m_currentMode != REALTIME_MODE) {
+        return;
+    }
+    recordTrendSamples(batch, values, &indexes);
+    applyBindingResults(batch, values, &indexes);
+}
+
+void ReportDataModel::drainTrendSamples()
+{
+    if (!m_sampleSet) return;
+
+    QVector<TrendSample> samples;
+    for (size_t i = 0; i < m_sampleSet->rings.size() && static_cast<int>(i) < m_trendHistory.size(); ++i) {
+        samples.clear();
+        if (m_sampleSet->rings[i]->drain(samples) == 0) continue;
+
+        QVector<QPointF>& history = m_trendHistory[static_cast<int>(i)];
+        for (const TrendSample& sample : samples) {
+            history.append(QPointF(static_cast<double>(sample.msecs), sample.value));
+        }
+        trimTrendHistory(history);
+    }
+}
+
+void ReportDataModel::recordTrendSamples(const UniversalQueryEngine::BatchHandle& batch, const QVariantList& values,
+    const QVector<int>* indexes)
+{
+    const BindingPlan& plan = bindingPlan();
+    const QStringList keys = UniversalQueryEngine::batchKeys(batch);
+    const double now = static_cast<double>(QDateTime::currentMSecsSinceEpoch());
+
+    const int count = indexes ? qMin(indexes->size(), values.size()) : qMin(keys.size(), values.size());
+    for (int n = 0; n < count; ++n) {
+        const int i = indexes ? indexes->at(n) : n;
+        if (i < 0 || i >= keys.size()) continue;
+
+        int keyIndex = plan.keyIndex.value(keys[i], -1);
+        if (keyIndex < 0 || keyIndex >= m_trendHistory.size()) continue;
+
+        bool ok = false;
+        double value = values[n].toDouble(&ok);
+        if (!ok || values[n].type() == QVariant::String) continue;
+
+        m_trendHistory[keyIndex].append(QPointF(now, value));
+        trimTrendHistory(m_trendHistory[keyIndex]);
+    }
+}
+
+void ReportDataModel::trimTrendHistory(QVector<QPointF>& history)
+{
+    if (history.size() > kTrendCapacity) {
+        history.remove(0, history.size() - kTrendCapacity);
+    }
+}
+
+void ReportDataModel::setBindingDeadband(const QString& bindingKey, double deadband)
+{
+    if (deadband > 0.0) {
+        m_bindingDeadbands[bindingKey] = deadband;
+    }
+    else {
+        m_bindingDeadbands.remove(bindingKey);
+    }
+}
+
+void ReportDataModel::clearBindingDeadbands()
+{
+    m_bindingDeadbands.clear();
+}
+
+void ReportDataModel::invalidateFormulaDependencies()
+{
+    m_formulaDepsDirty = true;
+}
+
+// 扫描公式建立反向依赖；超过阈值的大区域不展开，按区域逐个判断
+void ReportDataModel::ensureFormulaDependencies()
+{
+    if (!m_formulaDepsDirty) return;
+
+    const int kExpandLimit = 256;
+
+    m_formulaDependents.clear();
+    m_rangeDependents.clear();
+    m_formulaCellCount = 0;
+
+    for (auto it = m_cells.constBegin(); it != m_cells.constEnd(); ++it) {
+        const CellData* cell = it.value();
+        if (!cell || !cell->hasFormula) continue;
+
+        ++m_formulaCellCount;
+        const QVector<QRect> ranges = m_formulaEngine->referencedRanges(cell->formula);
+        for (const QRect& range : ranges) {
+            if (range.width() * range.height() > kExpandLimit) {
+                m_rangeDependents.append(qMakePair(range, it.key()));
+                continue;
+            }
+            // QRect 的 x 为行、y 为列
+            for (int row = range.left(); row <= range.right(); ++row) {
+                for (int col = range.top(); col <= range.bottom(); ++col) {
+                    m_formulaDependents[QPoint(row, col)].append(it.key());
+                }
+            }
+        }
+    }
+
+    m_formulaDepsDirty = false;
+}
+
+// 从变化的单元格出发沿依赖传播重算，结果变化的公式单元格追加到 changedCells
+void ReportDataModel::recalculateDependents(QVector<QPoint>& changedCells)
+{
+    ensureFormulaDependencies();
+    if (m_formulaDependents.isEmpty() && m_rangeDependents.isEmpty()) return;
+
+    QVector<QPoint> queue = changedCells;
+
+    // 循环引用保护：每个公式平均最多重算若干次
+    int budget = (m_formulaCellCount + 1) * 8;
+
+    for (int head = 0; head < queue.size(); ++head) {
+        const QPoint source = queue[head];
+
+        QVector<QPoint> dependents = m_formulaDependents.value(source);
+        for (const auto& entry : m_rangeDependents) {
+            if (entry.first.contains(source)) {
+                dependents.append(entry.second);
+            }
+        }
+
+        for (const QPoint& pos : dependents) {
+            if (--budget < 0) {
+                qWarning() << "公式依赖传播次数过多，可能存在循环引用";
+                return;
+            }
+
+            CellData* cell = getCell(pos.x(), pos.y());
+            if (!cell || !cell->hasFormula) continue;
+
+            QVariant oldValue = cell->value;
+            calculateFormula(pos.x(), pos.y());
+            if (cell->value != oldValue) {
+                queue.append(pos);
+                changedCells.append(pos);
+            }
+        }
+    }
+}
+
+// 将变化单元格合并为最少的矩形：先按行合并连续列，再合并列范围相同的相邻行
+void ReportDataModel::emitCellsChanged(const QVector<QPoint>& cells)
+{
+    if (cells.isEmpty()) return;
+
+    QVector<QPoint> sorted = cells;
+    std::sort(sorted.begin(), sorted.end(), [](const QPoint& a, const QPoint& b) {
+        return a.x() != b.x() ? a.x() < b.x() : a.y() < b.y();
+    });
+    sorted.erase(std::unique(sorted.begin(), sorted.end()), sorted.end());
+
+    struct Span { int top, bottom, left, right; };
+    QVector<Span> spans;
+    QHash<qint64, int> openSpans;   // (left,right) → 上一行结束的矩形
+
+    int i = 0;
+    while (i < sorted.size()) {
+        const int row = sorted[i].x();
+        const int left = sorted[i].y();
+        int right = left;
+        ++i;
+        while (i < sorted.size() && sorted[i].x() == row && sorted[i].y() == right + 1) {
+            ++right;
+            ++i;
+        }
+
+        const qint64 key = (static_cast<qint64>(left) << 32) | static_cast<quint32>(right);
+        auto open = openSpans.find(key);
+        if (open != openSpans.end() && spans[open.value()].bottom == row - 1) {
+            spans[open.value()].bottom = row;
+        }
+        else {
+            openSpans[key] = spans.size();
+            spans.append({ row, row, left, right });
+        }
+    }
+
+    // 矩形过多时退化为包围盒，避免信号风暴
+    const int kMaxRects = 64;
+    if (spans.size() > kMaxRects) {
+        Span box = spans.first();
+        for (const Span& span : spans) {
+            box.top = qMin(box.top, span.top);
+            box.bottom = qMax(box.bottom, span.bottom);
+            box.left = qMin(box.left, span.left);
+            box.right = qMax(box.right, span.right);
         }
+        spans = { box };
     }
 
-    // 通知整个视图刷新，因为多个单元格数据可能已改变
-    emit dataChanged(index(0, 0), index(m_maxRow - 1, m_maxCol - 1));
+    for (const Span& span : spans) {
+        if (span.top >= m_maxRow || span.left >= m_maxCol) continue;
+        emit dataChanged(index(span.top, span.left),
+            index(qMin(span.bottom, m_maxRow - 1), qMin(span.right, m_maxCol - 1)));
+    }
+}
+
+QSet<QString> ReportDataModel::bindingKeys()
+{
+    const QStringList& keys = bindingPlan().keys;
+    return QSet<QString>(keys.begin(), keys.end());
 }
 
 bool ReportDataModel::saveToExcel(const QString& fileName)
@@ -1049,6 +1628,8 @@ void ReportDataModel::clearAllCells()
     qDeleteAll(m_cells);
     m_cells.clear();
     clearSizes(); // <-- 新增这一行
+    invalidateBindingPlan();
+    invalidateFormulaDependencies();
 }
 
 void ReportDataModel::addCellDirect(int row, int col, CellData* cell)
@@ -1059,6 +1640,12 @@ void ReportDataModel::addCellDirect(int row, int col, CellData* cell)
         delete m_cells.take(key);
     }
     m_cells.insert(key, cell);
+    if (cell && cell->isDataBinding) {
+        invalidateBindingPlan();
+    }
+    if (cell && cell->hasFormula) {
+        invalidateFormulaDependencies();
+    }
 }
 
 void ReportDataModel::updateModelSize(int newRowCount, int newColCount)
@@ -1076,14 +1663,19 @@ const QHash<QPoint, CellData*>& ReportDataModel::getAllCells() const
 
 void ReportDataModel::recalculateAllFormulas()
 {
+    QVector<QPoint> changedCells;
     for (auto it = m_cells.constBegin(); it != m_cells.constEnd(); ++it) {
         if (it.value() && it.value()->hasFormula) {
             const QPoint& pos = it.key();
+            QVariant oldValue = it.value()->value;
             calculateFormula(pos.x(), pos.y());
+            if (it.value()->value != oldValue) {
+                changedCells.append(pos);
+            }
         }
     }
-    // 计算完成后，通知视图全局刷新数据
-    emit dataChanged(index(0, 0), index(m_maxRow - 1, m_maxCol - 1));
+    // 计算完成后，只通知结果变化的单元格
+    emitCellsChanged(changedCells);
 }
 
 // --- 工具和私有方法实现 ---
@@ -1110,6 +1702,116 @@ void ReportDataModel::calculateFormula(int row, int col)
     cell->value = result;
 }
 
+// 历史数据列：模型列 → 对齐数据（模型第 r 行对应数组下标 r-1）
+const QVector<double>* ReportDataModel::historyColumnData(int col) const
+{
+    if (m_currentMode != HISTORY_MODE || m_fullTimeAxis.isEmpty()) return nullptr;
+    if (col < 1 || col - 1 >= m_historyConfig.columns.size()) return nullptr;
+
+    auto it = m_fullAlignedData.constFind(m_historyConfig.columns[col - 1].rtuId);
+    if (it == m_fullAlignedData.constEnd()) return nullptr;
+    return &it.value();
+}
+
+// 历史报表阶段的虚拟单元格数值（时间列和数据列不在 m_cells 中）
+bool ReportDataModel::historyValueAt(int row, int col, QVariant& value) const
+{
+    if (m_currentMode != HISTORY_MODE || m_fullTimeAxis.isEmpty()) return false;
+
+    int dataRow = row - 1;
+    if (dataRow < 0 || dataRow >= m_fullTimeAxis.size()) return false;
+
+    if (col == 0) {
+        value = m_fullTimeAxis[dataRow].toString("yyyy-MM-dd HH:mm:ss");
+        return true;
+    }
+
+    const QVector<double>* values = historyColumnData(col);
+    if (!values) return false;
+
+    double v = dataRow < values->size() ? values->at(dataRow) : std::numeric_limits<double>::quiet_NaN();
+    value = (std::isnan(v) || std::isinf(v)) ? QVariant() : QVariant(v);
+    return true;
+}
+
+// 根据左侧列的存储数据判断填充终点（不走 data() 字符串格式化）
+int ReportDataModel::findFillEndRow(int sourceRow, int col) const
+{
+    int maxRow = sourceRow;
+
+    // 历史报表阶段：时间列和数据列是虚拟数据，一直延伸到时间轴末尾
+    if (m_currentMode == HISTORY_MODE && !m_fullTimeAxis.isEmpty() && col > 0) {
+        maxRow = qMax(maxRow, m_fullTimeAxis.size());
+    }
+
+    for (auto it = m_cells.constBegin(); it != m_cells.constEnd(); ++it) {
+        const QPoint& pos = it.key();
+        const CellData* cell = it.value();
+        if (!cell || pos.y() >= col || pos.x() <= maxRow) continue;
+
+        bool hasContent = cell->hasFormula || cell->isDataBinding;
+        if (!hasContent && !cell->value.isNull()) {
+            hasContent = cell->value.type() != QVariant::String
+                || !cell->value.toString().trimmed().isEmpty();
+        }
+
+        if (hasContent) {
+            maxRow = pos.x();
+        }
+    }
+
+    return qMin(maxRow, m_maxRow - 1);
+}
+
+// 批量向下填充：模板只编译一次，全部写入后统一求值，只发一次 dataChanged
+int ReportDataModel::fillDownFormula(int sourceRow, int col, int endRow)
+{
+    const CellData* source = getCell(sourceRow, col);
+    if (!source || !source->hasFormula) return 0;
+
+    if (m_currentMode == HISTORY_MODE &&
+        (m_fullTimeAxis.isEmpty() || m_historyConfig.dataColumns.contains(col))) {
+        qWarning() << "数据列为只读，无法填充公式";
+        return 0;
+    }
+
+    endRow = qMin(endRow, m_maxRow - 1);
+    if (endRow <= sourceRow) return 0;
+
+    const FormulaTemplate tmpl = FormulaEngine::compileTemplate(source->formula);
+
+    // 1. 写入公式
+    for (int row = sourceRow + 1; row <= endRow; ++row) {
+        CellData* cell = ensureCell(row, col);
+        if (cell->isDataBinding) {
+            cell->isDataBinding = false;
+            invalidateBindingPlan();
+        }
+        cell->setFormula(tmpl.instantiate(row - sourceRow));
+        invalidateFormulaDependencies();
+    }
+
+    // 2. 按行顺序求值，引用上方已填充单元格的公式也能拿到新值
+    for (int row = sourceRow + 1; row <= endRow; ++row) {
+        calculateFormula(row, col);
+    }
+
+    emit dataChanged(index(sourceRow + 1, col), index(endRow, col), { Qt::DisplayRole, Qt::EditRole });
+
+    // 引用填充区域的公式（如下方的合计行）随之重算
+    QVector<QPoint> changedCells;
+    changedCells.reserve(endRow - sourceRow);
+    for (int row = sourceRow + 1; row <= endRow; ++row) {
+        changedCells.append(QPoint(row, col));
+    }
+    const int filledCount = changedCells.size();
+    recalculateDependents(changedCells);
+    changedCells.remove(0, filledCount);
+    emitCellsChanged(changedCells);
+
+    return endRow - sourceRow;
+}
+
 CellData* ReportDataModel::getCell(int row, int col)
 {
     return m_cells.value(QPoint(row, col), nullptr);
@@ -1191,8 +1893,7 @@ GlobalDataConfig ReportDataModel::getGlobalConfig() const
 void ReportDataModel::updateGlobalTimeRange(const TimeRangeConfig& timeRange)
 {
     m_globalConfig.globalTimeRange = timeRange;
-    // 可选：发射信号通知时间范围已更新
-    emit dataChanged(index(0, 0), index(m_maxRow - 1, m_maxCol - 1));
+    // 时间范围不影响任何单元格的显示，无需通知视图
 }
 
 void ReportDataModel::restoreBindingsToConfigStage()
@@ -1202,16 +1903,21 @@ void ReportDataModel::restoreBindingsToConfigStage()
         return;
     }
 
-    for (auto it = m_cells.begin(); it != m_cells.end(); ++it) {
-        CellData* cell = it.value();
-        if (cell && cell->isDataBinding) {
-            // 将数值恢复为 ##RTU号
-            cell->value = cell->bindingKey;
+    QVector<QPoint> changedCells;
+    const BindingPlan& plan = bindingPlan();
+    for (const QVector<QPoint>& positions : plan.cells) {
+        for (const QPoint& pos : positions) {
+            CellData* cell = m_cells.value(pos, nullptr);
+            if (cell && cell->isDataBinding && cell->value != QVariant(cell->bindingKey)) {
+                // 将数值恢复为 ##RTU号
+                cell->value = cell->bindingKey;
+                changedCells.append(pos);
+            }
         }
     }
 
-    // 通知视图刷新所有单元格
-    emit dataChanged(index(0, 0), index(m_maxRow - 1, m_maxCol - 1));
+    // 只通知绑定单元格
+    emitCellsChanged(changedCells);
 
     qDebug() << "实时模式配置已还原";
 }
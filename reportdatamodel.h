@@ -2,15 +2,21 @@
 #define REPORTDATAMODEL_H
 
 #include "DataBindingConfig.h"
+#include "UniversalQueryEngine.h"
+#include "RtdbQueryWorker.h"
 #include <QHash>
 #include <QAbstractTableModel>
 #include <QFontInfo>      // 添加这个
 #include <QFontDatabase>  // 如果需要的话
 #include <QBrush>         // 添加这个
 #include <QPoint>
+#include <QRect>
+#include <QPointF>
 #include <QSize>
 #include <QVector> 
 #include <QProgressDialog>
+#include <QThread>
+#include <QVariantList>
 
 // qHash 函数必须在 QHash 使用之前定义
 inline uint qHash(const QPoint& key, uint seed = 0) noexcept
@@ -19,6 +25,7 @@ inline uint qHash(const QPoint& key, uint seed = 0) noexcept
 }
 
 class FormulaEngine;
+class RtdbSubscription;
 
 class ReportDataModel : public QAbstractTableModel
 {
@@ -33,6 +40,13 @@ public:
         HISTORY_MODE      // 历史报表生成模式
     };
 
+    // 自定义数据角色
+    // SparklineRole 只在数值变化时随 dataChanged 通知，趋势显示方需自行按低频率重绘
+    enum DataRole {
+        SparklineRole = Qt::UserRole + 1    // ## 绑定的近期趋势：QVector<QPointF>（x 为毫秒时间戳）
+    };
+    enum { kTrendCapacity = 128 };          // 每个绑定保留的趋势样本数
+
     //  添加模式管理接口
     void setWorkMode(WorkMode mode);
     WorkMode currentMode() const { return m_currentMode; }
@@ -46,18 +60,31 @@ public:
         const QHash<QString, QVector<double>>& alignedData,
         const QVector<QDateTime>& timeAxis
     );
+    // 流水线增量发布：报表框架已生成后写入一个 RTU 的对齐数据，只通知对应列刷新
+    void setHistoryColumnData(const QString& rtuId, const QVector<double>& values);
     bool exportHistoryReportToExcel(const QString& fileName, QProgressDialog* progress = nullptr);
     bool hasHistoryData() const { return !m_fullTimeAxis.isEmpty(); }
+    int historyPointCount() const { return m_fullTimeAxis.size(); }
     QString getReportName() const { return m_reportName; }
     const HistoryReportConfig& getHistoryConfig() const { return m_historyConfig; }
     bool hasDataBindings() const;  //  检查是否有##绑定
 
+    // 公式引擎访问历史数据（模型第 r 行对应时间轴下标 r-1）
+    const QVector<qint64>& timeAxisSeconds() const { return m_timeAxisSecs; }
+    const QVector<double>* historyColumnData(int col) const;
+    bool historyValueAt(int row, int col, QVariant& value) const;
+
     //  添加静态工具函数
     static QVector<QDateTime> generateTimeAxis(const TimeRangeConfig& config);
     static QHash<QString, QVector<double>> alignDataWithInterpolation(
         const QHash<QString, std::map<int64_t, std::vector<float>>>& rawData,
         const QVector<QDateTime>& timeAxis
     );
+    // 单个 RTU 的对齐（时间轴为秒值），无数据时全部为 NaN
+    static QVector<double> alignSeriesWithInterpolation(
+        const std::map<int64_t, std::vector<float>>& dataMap,
+        const QVector<qint64>& timeAxisSecs
+    );
 
     // Qt Model 接口
     int rowCount(const QModelIndex& parent = QModelIndex()) const override;
@@ -90,6 +117,10 @@ public:
     void calculateFormula(int row, int col);
     QString cellAddress(int row, int col) const;
 
+    // 批量向下填充公式
+    int findFillEndRow(int sourceRow, int col) const;
+    int fillDownFormula(int sourceRow, int col, int endRow);
+
     // 全局配置管理
     void setGlobalConfig(const GlobalDataConfig& config);
     GlobalDataConfig getGlobalConfig() const;
@@ -106,17 +137,82 @@ public:
 
     // 数据绑定
     void resolveDataBindings();
+    void resolveDataBindings(const QSet<QString>& onlyKeys);
+    QSet<QString> bindingKeys();
+    quint64 requestDataBindingsAsync(const QSet<QString>& onlyKeys = QSet<QString>());
+    bool isBindingRefreshInProgress() const { return m_bindingRefreshActive || m_pendingRequestId != 0; }
+
+    // 变化死区：新旧数值之差不超过死区时不更新单元格（0 表示任何变化都更新）
+    void setBindingDeadband(const QString& bindingKey, double deadband);
+    void clearBindingDeadbands();
+
+    // 订阅模式：变化推送到达时只更新受影响的单元格
+    bool startBindingSubscription(UniversalQueryEngine::SubscriptionSource source, int intervalMs);
+    void stopBindingSubscription();
+    bool isSubscriptionActive() const { return m_subscription != nullptr; }
 
     QFont ensureFontAvailable(const QFont& requestedFont) const;
 
+    // 样式缓存：相同字体/颜色只解析一次，data() 绘制期间只做查表
+    struct StyleCacheStats {
+        quint64 fontHits = 0;
+        quint64 fontMisses = 0;
+        quint64 brushHits = 0;
+        quint64 brushMisses = 0;
+        int fontEntries = 0;
+        int brushEntries = 0;
+    };
+    StyleCacheStats styleCacheStats() const;
+    void clearStyleCaches();
+
     void restoreBindingsToConfigStage();
 
 private:
+    // 绑定计划：去重后的键、预编译的RTDB批次、键 → 单元格反向索引
+    struct BindingPlan {
+        QStringList keys;
+        QHash<QString, int> keyIndex;
+        QVector<QVector<QPoint>> cells;                       // 与 keys 下标对应
+        UniversalQueryEngine::BatchHandle batch;
+    };
+
     QVariant getRealtimeCellData(const QModelIndex& index, int role) const;
     QVariant getHistoryReportCellData(const QModelIndex& index, int role) const;
+    QFont cachedFont(const QFont& requestedFont) const;
+    QBrush cachedBrush(const QColor& color) const;
+
+    // 绑定计划：模板加载或绑定编辑后重新编译，刷新时直接使用
+    void invalidateBindingPlan();
+    const BindingPlan& bindingPlan();
+    UniversalQueryEngine::BatchHandle batchForKeys(const QSet<QString>& onlyKeys);
+    // indexes 为空时 values 覆盖整个批次，否则与 indexes 一一对应
+    void applyBindingResults(const UniversalQueryEngine::BatchHandle& batch, const QVariantList& values,
+        const QVector<int>* indexes = nullptr);
+    void pushSubscriptionBatch();
+
+    // 趋势样本：异步查询经环形缓冲区写入，同步查询和订阅在界面线程直接记录
+    void drainTrendSamples();
+    void recordTrendSamples(const UniversalQueryEngine::BatchHandle& batch, const QVariantList& values,
+        const QVector<int>* indexes);
+    void trimTrendHistory(QVector<QPointF>& history);
+
+    // 增量刷新：只重算受影响的公式，变化单元格合并成最小矩形通知视图
+    void invalidateFormulaDependencies();
+    void ensureFormulaDependencies();
+    void recalculateDependents(QVector<QPoint>& changedCells);
+    void emitCellsChanged(const QVector<QPoint>& cells);
+
+private slots:
+    void onBindingQueryFinished(quint64 requestId, const UniversalQueryEngine::BatchHandle& batch,
+        const QVariantList& values, qint64 elapsedMs, const UniversalQueryEngine::ChunkTimingList& chunkTimings);
+    void onSubscriptionValuesChanged(const UniversalQueryEngine::BatchHandle& batch,
+        const QVector<int>& indexes, const QVariantList& values);
 
 signals:
     void cellChanged(int row, int col);
+    void bindingQueryRequested(quint64 requestId, const UniversalQueryEngine::BatchHandle& batch,
+        const BindingSampleSetPtr& samples);
+    void bindingRefreshFinished(qint64 roundTripMs, qint64 queryMs, const UniversalQueryEngine::ChunkTimingList& chunkTimings);
 
 private:
     QHash<QPoint, CellData*> m_cells;        // 改为CellData*
@@ -132,7 +228,53 @@ private:
     QString m_reportName;                                     // 报表名称
     HistoryReportConfig m_historyConfig;                      // 报表配置
     QVector<QDateTime> m_fullTimeAxis;                        // 完整时间轴
+    QVector<qint64> m_timeAxisSecs;                           // 时间轴秒值（时序函数用）
     QHash<QString, QVector<double>> m_fullAlignedData;        // 对齐后的数据
+
+    bool m_bindingRefreshActive;                              // 同步绑定刷新进行中
+
+    BindingPlan m_bindingPlan;
+    bool m_bindingPlanDirty;                                  // 绑定增删后需重新编译
+    QHash<QString, UniversalQueryEngine::BatchHandle> m_subsetBatches;   // 按刷新等级拆分的子批次
+    QHash<QString, double> m_bindingDeadbands;                // 绑定键 → 死区
+    // 字体/画刷缓存（data() 为 const，故为 mutable）
+    struct FontCacheKey {
+        QString family;
+        qreal pointSize;
+        int pixelSize;
+        int weight;
+        bool italic;
+        bool underline;
+        bool strikeOut;
+
+        bool operator==(const FontCacheKey& other) const {
+            return family == other.family && pointSize == other.pointSize && pixelSize == other.pixelSize &&
+                weight == other.weight && italic == other.italic && underline == other.underline &&
+                strikeOut == other.strikeOut;
+        }
+    };
+    friend uint qHash(const FontCacheKey& key, uint seed);
+    mutable QHash<FontCacheKey, QFont> m_fontCache;
+    mutable QHash<QRgb, QBrush> m_brushCache;
+    mutable StyleCacheStats m_styleCacheStats;
+
+    BindingSampleSetPtr m_sampleSet;                          // 查询线程写入的趋势缓冲区
+    QVector<QVector<QPointF>> m_trendHistory;                 // 与绑定计划键下标对应
+
+    // 公式依赖：被引用单元格 → 引用它的公式单元格；大区域单独存放，避免展开
+    QHash<QPoint, QVector<QPoint>> m_formulaDependents;
+    QVector<QPair<QRect, QPoint>> m_rangeDependents;
+    int m_formulaCellCount;
+    bool m_formulaDepsDirty;
+
+    // 异步RTDB查询：每个报表使用独立的查询引擎（独立的RTDB会话池）
+    std::unique_ptr<UniversalQueryEngine> m_queryEngine;
+    QThread m_queryThread;
+    RtdbQueryWorker* m_queryWorker;
+    quint64 m_latestRequestId;
+    quint64 m_pendingRequestId;                               // 0 表示没有未返回的请求
+    qint64 m_pendingSince;
+    RtdbSubscription* m_subscription;                         // 运行在查询线程
 };
 
 #endif // REPORTDATAMODEL_H
\ No newline at end of file